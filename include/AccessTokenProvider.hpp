@@ -0,0 +1,183 @@
+#ifndef FAQ_ACCESSTOKENPROVIDER_HPP
+#define FAQ_ACCESSTOKENPROVIDER_HPP
+#include "HttpClientPool.hpp"
+#include "SingleFlight.hpp"
+#include "Tools.hpp"
+#include "json/json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+using json = nlohmann::json;
+/*
+ * Fourniture du jeton d'accès oauth2 d'un service account Google.
+ * Le jeton est renouvelé par un thread dédié avant son expiration (d'après le expires_in retourné par Google) : les
+ * threads qui l'utilisent le lisent sans verrou et n'attendent jamais sa génération. La clé privée RSA servant à
+ * signer le jeton JWT est lue une seule fois, à la construction.
+ */
+class AccessTokenProvider
+{
+  public:
+    /*
+     * Constructeur, démarre le thread de renouvellement.
+     * @param pOAuthUrl : adresse du serveur d'authentification oauth2.
+     * @param pServiceAccount : adresse mail du service account.
+     * @param pPrivateKey : clé privée (PEM) du service account.
+     * @param pScope : périmètre d'accès demandé.
+     */
+    AccessTokenProvider(const std::string &pOAuthUrl, const std::string &pServiceAccount,
+                        const std::string &pPrivateKey, const std::string &pScope)
+        : mOAuthClients(pOAuthUrl, 1, std::chrono::seconds(10), std::chrono::seconds(20)),
+          mServiceAccount(pServiceAccount), mScope(pScope)
+    {
+        mToken.store(std::make_shared<const std::string>());
+        try
+        {
+            mSigner.emplace("", pPrivateKey, "", "");
+        }
+        catch (const std::exception &e)
+        {
+            // sans clé valide aucun jeton ne peut être généré, les écritures échoueront.
+            std::cout << "clé privée du service account invalide : " << e.what() << std::endl;
+            return;
+        }
+        mRefreshThread = std::thread([this]() { run(); });
+    }
+    AccessTokenProvider(const AccessTokenProvider &) = delete;
+    AccessTokenProvider &operator=(const AccessTokenProvider &) = delete;
+
+    ~AccessTokenProvider()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mCondition.notify_all();
+        if (mRefreshThread.joinable())
+            mRefreshThread.join();
+    }
+    /*
+     * @return le jeton d'accès courant, vide s'il n'a pas encore pu être obtenu.
+     */
+    std::shared_ptr<const std::string> getToken() const
+    {
+        return mToken.load();
+    }
+    /*
+     * Obtention immédiate d'un jeton, pour un appelant qui ne peut pas attendre le thread de renouvellement (aucun
+     * jeton obtenu depuis le démarrage ...). Bloquant : si un jeton est déjà en cours de génération, son résultat est
+     * attendu plutôt que d'en générer un autre.
+     * @return le jeton d'accès courant, vide en cas d'échec.
+     */
+    std::shared_ptr<const std::string> fetchToken()
+    {
+        if (mSigner.has_value())
+            refresh();
+        return mToken.load();
+    }
+    /*
+     * Demande un renouvellement immédiat (jeton refusé par l'API ...), non bloquant.
+     */
+    void requestRefresh()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRefreshRequested = true;
+        }
+        mCondition.notify_all();
+    }
+
+  private:
+    /*
+     * Boucle du thread de renouvellement.
+     */
+    void run()
+    {
+        std::chrono::seconds retry(0);
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (!mStop)
+        {
+            mRefreshRequested = false;
+            lock.unlock();
+            auto expiresIn = refresh();
+            lock.lock();
+
+            std::chrono::seconds wait;
+            if (expiresIn.has_value())
+            {
+                retry = std::chrono::seconds(0);
+                // renouvellement 5 minutes avant l'expiration (à mi-durée pour un jeton très court), jamais moins de
+                // 30s après le précédent : un expires_in nul, absent ou invalide ne doit pas emballer la boucle.
+                wait = std::max({expiresIn.value() - std::chrono::seconds(300), expiresIn.value() / 2,
+                                 std::chrono::seconds(30)});
+            }
+            else
+            {
+                // échec : nouvel essai après 5s, 10s, 20s ... jusqu'à 5 minutes, l'ancien jeton reste utilisé.
+                retry = std::min(std::max(retry * 2, std::chrono::seconds(5)), std::chrono::seconds(300));
+                wait = retry;
+            }
+            mCondition.wait_for(lock, wait, [this]() { return mStop || mRefreshRequested; });
+        }
+    }
+    /*
+     * Renouvellement du jeton, un seul à la fois (thread de renouvellement et appels à fetchToken).
+     * @return la durée de validité du nouveau jeton, null en cas d'échec.
+     */
+    std::optional<std::chrono::seconds> refresh()
+    {
+        return mMints.run(mScope, [this]() { return mint(); });
+    }
+    /*
+     * Génération d'un jeton JWT signé et échange contre un jeton d'accès oauth2.
+     * @return la durée de validité du nouveau jeton, null en cas d'échec.
+     */
+    std::optional<std::chrono::seconds> mint()
+    {
+        try
+        {
+            std::string assertion =
+                Tools::JWTToken(mServiceAccount, mScope, "https://oauth2.googleapis.com/token", mSigner.value());
+            auto res = mOAuthClients.send([&assertion](httplib::Client &client) {
+                return client.Post(
+                    "/token?grant_type=urn%3Aietf%3Aparams%3Aoauth%3Agrant-type%3Ajwt-bearer&assertion=" + assertion);
+            });
+            if (!res || res->status != 200)
+            {
+                std::cout << "obtention du jeton d'accès oauth2 impossible : "
+                          << (res ? std::to_string(res->status) : httplib::to_string(res.error())) << std::endl;
+                return std::nullopt;
+            }
+            auto body = json::parse(res->body);
+            mToken.store(std::make_shared<const std::string>(body.at("access_token").get<std::string>()));
+            return std::chrono::seconds(body.value("expires_in", 3600));
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "obtention du jeton d'accès oauth2 impossible : " << e.what() << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    HttpClientPool mOAuthClients;
+    std::string mServiceAccount;
+    std::string mScope;
+    // algorithme de signature, la clé privée n'est analysée qu'une fois.
+    std::optional<jwt::algorithm::rs256> mSigner;
+    // jeton courant, lu sans verrou par les autres threads.
+    std::atomic<std::shared_ptr<const std::string>> mToken;
+    // génération de jeton en cours.
+    SingleFlight<std::string, std::optional<std::chrono::seconds>> mMints;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStop{false};
+    bool mRefreshRequested{false};
+    std::thread mRefreshThread;
+};
+#endif
@@ -0,0 +1,255 @@
+#ifndef FAQ_CACHEDDATAACCESS_HPP
+#define FAQ_CACHEDDATAACCESS_HPP
+#include "FAQRow.hpp"
+#include "FAQSnapshot.hpp"
+#include "SnapshotFile.hpp"
+#include "IDataAccess.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+/*
+ * Couche de cache autour d'un IDataAccess.
+ * Les Q/R validées sont conservées dans une photographie immuable rafraîchie périodiquement par un thread
+ * dédié. Les lectures ne font jamais d'appel à la couche de données sous-jacente : en cas d'échec ou de lenteur
+ * du rafraîchissement, la dernière photographie valide continue d'être servie.
+ * À chaque rafraîchissement le jeton de changement de la couche sous-jacente est d'abord comparé au précédent, les
+ * données ne sont relues que s'il a changé.
+ */
+class CachedDataAccess : public IDataAccess
+{
+  public:
+    /*
+     * Constructeur, démarre le thread de rafraîchissement.
+     * @param pDataAccess : couche de données sous-jacente (google sheets, sqlite ...).
+     * @param pRefreshInterval : intervalle entre deux rafraîchissements.
+     * @param pInitialData : couche de données locale (copie SQLite ...) lue immédiatement à la construction, afin de
+     * servir son contenu sans attendre le premier rafraîchissement (optionnel).
+     * @param pSnapshotFile : fichier dans lequel chaque nouvelle photographie est sauvegardée, et relu en priorité à
+     * la construction (optionnel).
+     */
+    CachedDataAccess(IDataAccess &pDataAccess, std::chrono::seconds pRefreshInterval,
+                     IDataAccess *pInitialData = nullptr, const std::string &pSnapshotFile = "")
+        : mDataAccess(pDataAccess), mRefreshInterval(pRefreshInterval), mSnapshotFile(pSnapshotFile)
+    {
+        mSnapshot.store(std::make_shared<const FAQSnapshot>());
+        if (!loadSnapshotFile() && pInitialData != nullptr)
+            preload(*pInitialData);
+        mRefreshThread = std::thread([this]() { run(); });
+    }
+    CachedDataAccess(const CachedDataAccess &) = delete;
+    CachedDataAccess &operator=(const CachedDataAccess &) = delete;
+
+    virtual ~CachedDataAccess()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mCondition.notify_all();
+        if (mRefreshThread.joinable())
+            mRefreshThread.join();
+    }
+
+    virtual bool createQuestion(const std::string &question, unsigned int numQuestion = 0)
+    {
+        // une question créée n'a pas de réponse validée, inutile de rafraîchir la photographie.
+        return mDataAccess.createQuestion(question, numQuestion);
+    }
+    virtual CreatedQuestions createQuestions(const std::vector<NewQuestion> &questions)
+    {
+        return mDataAccess.createQuestions(questions);
+    }
+    virtual bool updateQuestion(int rowid, const std::string &reponse, bool reponse_valide)
+    {
+        bool retour = mDataAccess.updateQuestion(rowid, reponse, reponse_valide);
+        if (retour)
+            requestRefresh();
+        return retour;
+    }
+    virtual bool deleteQuestion(int rowid)
+    {
+        bool retour = mDataAccess.deleteQuestion(rowid);
+        if (retour)
+            requestRefresh();
+        return retour;
+    }
+    /*
+     * Retourne les Q/R validées de la dernière photographie, sans jamais interroger la couche sous-jacente.
+     * @return les Q/R validées ou null si aucune photographie n'a encore pu être chargée.
+     */
+    virtual std::optional<std::vector<FAQRow>> getAllValidated()
+    {
+        auto snapshot = getSnapshot();
+        if (snapshot->version == 0)
+            return std::nullopt;
+        return {snapshot->rows};
+    }
+    /*
+     * Page des Q/R validées, découpée directement dans la dernière photographie.
+     */
+    virtual std::optional<std::vector<FAQRow>> getValidatedPage(std::size_t offset, std::size_t limit)
+    {
+        auto snapshot = getSnapshot();
+        if (snapshot->version == 0)
+            return std::nullopt;
+        auto first = snapshot->rows.begin() + std::min(offset, snapshot->rows.size());
+        auto last = first + std::min(limit, static_cast<std::size_t>(snapshot->rows.end() - first));
+        return {std::vector<FAQRow>(first, last)};
+    }
+    /*
+     * Les Q/R non validées ne sont pas mises en cache.
+     */
+    virtual std::optional<std::vector<FAQRow>> getAll()
+    {
+        return mDataAccess.getAll();
+    }
+    /*
+     * Recherche déléguée à la couche de données (non mise en cache).
+     */
+    virtual std::optional<std::vector<FAQRow>> search(const std::string &query, std::size_t limit)
+    {
+        return mDataAccess.search(query, limit);
+    }
+    /*
+     * @return la dernière photographie publiée, à conserver le temps de son utilisation.
+     */
+    std::shared_ptr<const FAQSnapshot> getSnapshot() const
+    {
+        return mSnapshot.load();
+    }
+    /*
+     * Demande un rafraîchissement immédiat au thread dédié (non bloquant).
+     */
+    void requestRefresh()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRefreshRequested = true;
+        }
+        mCondition.notify_all();
+    }
+
+  private:
+    /*
+     * Publication de la photographie sauvegardée lors de la précédente exécution.
+     * @return vrai si une photographie a été chargée.
+     */
+    bool loadSnapshotFile()
+    {
+        if (mSnapshotFile.empty())
+            return false;
+        auto snapshot = SnapshotFile::read(mSnapshotFile);
+        if (!snapshot.has_value() || snapshot->version == 0)
+            return false;
+        std::cout << snapshot->rows.size() << " Q/R chargées depuis " << mSnapshotFile << std::endl;
+        mSnapshot.store(std::make_shared<const FAQSnapshot>(std::move(snapshot.value())));
+        return true;
+    }
+    /*
+     * Publication d'une première photographie à partir d'une couche de données locale.
+     */
+    void preload(IDataAccess &initialData)
+    {
+        std::optional<std::vector<FAQRow>> rows;
+        try
+        {
+            rows = initialData.getAllValidated();
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "lecture des données locales impossible : " << e.what() << std::endl;
+        }
+        // une copie locale vide (premier démarrage) n'est pas publiée.
+        if (!rows.has_value() || rows->empty())
+            return;
+        std::cout << rows->size() << " Q/R chargées depuis la copie locale" << std::endl;
+        auto snapshot = std::make_shared<FAQSnapshot>();
+        snapshot->rows = std::move(rows.value());
+        snapshot->version = 1;
+        snapshot->lastModified = std::time(nullptr);
+        mSnapshot.store(std::move(snapshot));
+    }
+    /*
+     * Boucle du thread de rafraîchissement.
+     */
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (!mStop)
+        {
+            // une demande explicite (après modification) relit les données sans tenir compte du jeton.
+            bool force = mRefreshRequested;
+            mRefreshRequested = false;
+            lock.unlock();
+            refresh(force);
+            lock.lock();
+            mCondition.wait_for(lock, mRefreshInterval, [this]() { return mStop || mRefreshRequested; });
+        }
+    }
+    /*
+     * Interroge la couche sous-jacente et publie une nouvelle photographie si le contenu a changé.
+     * @param force : relit les données même si le jeton de changement est inchangé.
+     */
+    void refresh(bool force)
+    {
+        std::optional<std::vector<FAQRow>> rows;
+        std::optional<std::string> changeToken;
+        try
+        {
+            // le jeton est lu avant les données : une modification intervenue entre les deux sera vue au prochain
+            // rafraîchissement.
+            changeToken = mDataAccess.getChangeToken();
+            if (!force && changeToken.has_value() && changeToken == mChangeToken && mSnapshot.load()->version != 0)
+                return;
+            rows = mDataAccess.getAllValidated();
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "rafraîchissement du cache impossible : " << e.what() << std::endl;
+        }
+        if (!rows.has_value())
+        {
+            std::cout << "rafraîchissement du cache en échec, conservation de la version "
+                      << mSnapshot.load()->version << std::endl;
+            return;
+        }
+
+        mChangeToken = changeToken;
+        auto current = mSnapshot.load();
+        // on ne publie une nouvelle version que si le contenu a réellement changé.
+        if (current->version != 0 && current->rows == rows.value())
+            return;
+
+        auto snapshot = std::make_shared<FAQSnapshot>();
+        snapshot->rows = std::move(rows.value());
+        snapshot->version = current->version + 1;
+        snapshot->lastModified = std::time(nullptr);
+        mSnapshot.store(snapshot);
+        // sauvegarde pour le prochain démarrage, hors du chemin des requêtes.
+        if (!mSnapshotFile.empty())
+            SnapshotFile::write(mSnapshotFile, *snapshot);
+    }
+
+    IDataAccess &mDataAccess;
+    std::chrono::seconds mRefreshInterval;
+    std::string mSnapshotFile;
+    // photographie courante, lue sans verrou par les threads de requête.
+    std::atomic<std::shared_ptr<const FAQSnapshot>> mSnapshot;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStop{false};
+    bool mRefreshRequested{false};
+    // jeton de changement des dernières données lues (utilisé uniquement par le thread de rafraîchissement).
+    std::optional<std::string> mChangeToken;
+    std::thread mRefreshThread;
+};
+#endif
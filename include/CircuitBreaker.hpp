@@ -0,0 +1,99 @@
+#ifndef FAQ_CIRCUITBREAKER_HPP
+#define FAQ_CIRCUITBREAKER_HPP
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+/*
+ * Disjoncteur protégeant les appels vers un service distant.
+ * - fermé : les appels passent, les échecs consécutifs sont comptés ;
+ * - ouvert : après trop d'échecs consécutifs, les appels sont refusés immédiatement pendant un certain temps, les
+ *   threads ne restent donc pas bloqués sur un service en panne ;
+ * - semi-ouvert : une fois ce temps écoulé un seul appel d'essai est autorisé, son succès referme le disjoncteur et
+ *   son échec le rouvre.
+ */
+class CircuitBreaker
+{
+  public:
+    /*
+     * Constructeur.
+     * @param pName : nom du service protégé (pour les traces).
+     * @param pFailureThreshold : nombre d'échecs consécutifs ouvrant le disjoncteur.
+     * @param pOpenDuration : durée pendant laquelle les appels sont refusés.
+     */
+    CircuitBreaker(const std::string &pName, unsigned int pFailureThreshold = 5,
+                   std::chrono::seconds pOpenDuration = std::chrono::seconds(30))
+        : mName(pName), mFailureThreshold(pFailureThreshold), mOpenDuration(pOpenDuration)
+    {
+    }
+    CircuitBreaker(const CircuitBreaker &) = delete;
+    CircuitBreaker &operator=(const CircuitBreaker &) = delete;
+    /*
+     * Autorisation d'un appel, à faire suivre d'un appel à record() si elle est accordée.
+     * @return vrai si l'appel peut être tenté, faux s'il doit échouer immédiatement.
+     */
+    bool allow()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        switch (mState)
+        {
+            case State::CLOSED:
+                return true;
+            case State::OPEN:
+                if (std::chrono::steady_clock::now() < mOpenUntil)
+                    return false;
+                // délai écoulé : cet appel sert d'essai.
+                mState = State::HALF_OPEN;
+                std::cout << mName << " : disjoncteur semi-ouvert, appel d'essai" << std::endl;
+                return true;
+            case State::HALF_OPEN:
+                // un essai est déjà en cours.
+                return false;
+        }
+        return false;
+    }
+    /*
+     * Résultat d'un appel autorisé.
+     * @param success : vrai si le service a répondu normalement.
+     */
+    void record(bool success)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (success)
+        {
+            if (mState != State::CLOSED)
+                std::cout << mName << " : disjoncteur fermé" << std::endl;
+            mState = State::CLOSED;
+            mFailures = 0;
+            return;
+        }
+        mFailures++;
+        if (mState == State::HALF_OPEN || mFailures >= mFailureThreshold)
+        {
+            if (mState != State::OPEN)
+                std::cout << mName << " : disjoncteur ouvert pour " << mOpenDuration.count() << "s après "
+                          << mFailures << " échecs" << std::endl;
+            mState = State::OPEN;
+            mOpenUntil = std::chrono::steady_clock::now() + mOpenDuration;
+        }
+    }
+
+  private:
+    enum class State
+    {
+        CLOSED,
+        OPEN,
+        HALF_OPEN
+    };
+
+    std::string mName;
+    unsigned int mFailureThreshold;
+    std::chrono::seconds mOpenDuration;
+    std::mutex mMutex;
+    State mState{State::CLOSED};
+    // échecs consécutifs.
+    unsigned int mFailures{0};
+    // fin de la période d'ouverture.
+    std::chrono::steady_clock::time_point mOpenUntil;
+};
+#endif
@@ -0,0 +1,91 @@
+#ifndef FAQ_COMPILEDTEMPLATE_HPP
+#define FAQ_COMPILEDTEMPLATE_HPP
+#include <iterator>
+#include <string>
+#include <string_view>
+/*
+ * Support d'exécution des templates compilés par tools/mustache2cpp.
+ */
+namespace CompiledTemplate
+{
+/*
+ * Élément courant au premier niveau du template (hors de toute liste).
+ */
+struct Root
+{
+};
+/*
+ * Passage unique (ou aucun) dans un bloc booléen, l'élément courant reste celui du bloc englobant.
+ */
+template <typename Item> struct Once
+{
+    const Item *item;
+    const Item *begin() const
+    {
+        return item;
+    }
+    const Item *end() const
+    {
+        return item == nullptr ? item : item + 1;
+    }
+};
+/*
+ * Parcours d'un bloc {{#nom}} booléen.
+ * @param value : valeur du booléen.
+ * @param outer : élément courant du bloc englobant.
+ */
+template <typename Item> Once<Item> iterate(bool value, const Item &outer)
+{
+    return {value ? &outer : nullptr};
+}
+/*
+ * Parcours d'un bloc {{#nom}} sur une liste, chaque élément devient l'élément courant.
+ * @param values : la liste.
+ */
+template <typename Range, typename Item> const Range &iterate(const Range &values, const Item &)
+{
+    return values;
+}
+/*
+ * @return vrai si un bloc {{^nom}} doit être rendu.
+ */
+inline bool isEmpty(bool value)
+{
+    return !value;
+}
+template <typename Range> bool isEmpty(const Range &values)
+{
+    return std::empty(values);
+}
+/*
+ * Ajout d'un texte au tampon en échappant les caractères html (mêmes règles que crow::mustache).
+ * @param out : tampon de sortie.
+ * @param in : texte à échapper.
+ */
+inline void appendEscaped(std::string &out, std::string_view in)
+{
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < in.size(); i++)
+    {
+        std::string_view entity;
+        switch (in[i])
+        {
+            case '&': entity = "&amp;"; break;
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+            case '"': entity = "&quot;"; break;
+            case '\'': entity = "&#39;"; break;
+            case '/': entity = "&#x2F;"; break;
+            case '`': entity = "&#x60;"; break;
+            case '=': entity = "&#x3D;"; break;
+            default: continue;
+        }
+        // les portions sans caractère spécial sont copiées d'un bloc.
+        out.append(in.substr(start, i - start));
+        out += entity;
+        start = i + 1;
+    }
+    out.append(in.substr(start));
+}
+} // namespace CompiledTemplate
+#endif
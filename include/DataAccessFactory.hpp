@@ -0,0 +1,98 @@
+#ifndef FAQ_DATAACCESSFACTORY_HPP
+#define FAQ_DATAACCESSFACTORY_HPP
+#include "GoogleSheetDataAccess.hpp"
+#include "IDataAccess.hpp"
+#include "ReplicatedDataAccess.hpp"
+#include "SqliteDataAccess.hpp"
+#include "json/json.hpp"
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+using json = nlohmann::json;
+/*
+ * Création de la couche de données choisie par la clé "backend" du fichier de configuration :
+ * - "sheets" : la feuille google sheets est lue et modifiée directement ;
+ * - "sqlite" : base SQLite locale uniquement, aucun appel vers Google ;
+ * - "replicated" : la feuille reste la référence, elle est recopiée dans la base SQLite qui sert les lectures.
+ * Sans clé "backend", "replicated" est choisi si une base ("database") est configurée, "sheets" sinon.
+ * Les couches créées appartiennent à la fabrique et vivent aussi longtemps qu'elle.
+ */
+class DataAccessFactory
+{
+  public:
+    /*
+     * Constructeur, crée les couches de données nécessaires au backend choisi.
+     * @param config : contenu du fichier de configuration.
+     * @throw std::invalid_argument si le backend est inconnu.
+     */
+    DataAccessFactory(const json &config)
+    {
+        std::string database = config.value("database", "");
+        std::string backend = config.value("backend", database.empty() ? "sheets" : "replicated");
+        std::cout << "couche de données : " << backend << std::endl;
+
+        if (backend == "sheets")
+            mDataAccess = &createSheets(config);
+        else if (backend == "sqlite")
+            mDataAccess = &createDatabase(config, database.empty() ? "faq.db" : database);
+        else if (backend == "replicated")
+        {
+            auto &source = createSheets(config);
+            auto &replica = createDatabase(config, database.empty() ? "faq.db" : database);
+            mDataAccess = &mReplicated.emplace(source, replica);
+            // la copie locale permet de servir la FAQ avant la première synchronisation.
+            mInitialData = &replica;
+        }
+        else
+            throw std::invalid_argument("backend inconnu : " + backend);
+    }
+    DataAccessFactory(const DataAccessFactory &) = delete;
+    DataAccessFactory &operator=(const DataAccessFactory &) = delete;
+    /*
+     * @return la couche de données à utiliser.
+     */
+    IDataAccess &getDataAccess() const
+    {
+        return *mDataAccess;
+    }
+    /*
+     * @return la couche locale dont le contenu peut être servi dès le démarrage, null s'il n'y en a pas.
+     */
+    IDataAccess *getInitialData() const
+    {
+        return mInitialData;
+    }
+
+  private:
+    /*
+     * Instanciation du GoogleSheetDataAccess avec les paramètres du fichier de configuration.
+     */
+    GoogleSheetDataAccess &createSheets(const json &config)
+    {
+        return mSheets.emplace(config.at("spreadsheetId"), config.at("apikey"), config.at("tab"),
+                               config.at("privateKey"), config.at("serviceAccount"), config.at("fields"),
+                               config.value("sheetsUrl", "https://sheets.googleapis.com"),
+                               config.value("driveUrl", "https://www.googleapis.com"),
+                               config.value("oauthUrl", "https://oauth2.googleapis.com"),
+                               config.value("chunkRows", 2000));
+    }
+    /*
+     * Ouverture de la base SQLite, avec les réglages optionnels de la clé "sqlite" (mode WAL, mmap ...).
+     */
+    SqliteDataAccess &createDatabase(const json &config, const std::string &path)
+    {
+        auto tuning = config.value("sqlite", json::object());
+        return mDatabase.emplace(path, SqliteOptions{tuning.value("journalMode", ""), tuning.value("synchronous", ""),
+                                                     tuning.value("cacheSize", 0),
+                                                     tuning.value("mmapSize", int64_t{0})});
+    }
+
+    std::optional<GoogleSheetDataAccess> mSheets;
+    std::optional<SqliteDataAccess> mDatabase;
+    std::optional<ReplicatedDataAccess> mReplicated;
+    IDataAccess *mDataAccess{nullptr};
+    IDataAccess *mInitialData{nullptr};
+};
+#endif
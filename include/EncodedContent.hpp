@@ -0,0 +1,92 @@
+#ifndef FAQ_ENCODEDCONTENT_HPP
+#define FAQ_ENCODEDCONTENT_HPP
+#include "Tools.hpp"
+#include <crow.h>
+#include <crow/compression.h>
+#include <string>
+/*
+ * Contenu HTTP accompagné de ses variantes compressées (gzip, deflate).
+ * La compression est faite une seule fois, au remplissage du cache ou au démarrage, puis chaque réponse
+ * sert directement la variante acceptée par le client.
+ */
+struct EncodedContent
+{
+    // type MIME du contenu.
+    std::string contentType;
+    // contenu non compressé.
+    std::string identity;
+    // variantes compressées, vides si la compression n'apporte rien.
+    std::string gzip;
+    std::string deflate;
+    // ETag fort du contenu non compressé, sans guillemets.
+    std::string etag;
+    // date de dernière modification au format HTTP.
+    std::string lastModified;
+
+    /*
+     * Construction du contenu, calcul de l'ETag et des variantes compressées.
+     * @param pContentType : type MIME.
+     * @param pBody : contenu non compressé.
+     * @param pLastModified : date de dernière modification au format HTTP.
+     * @param pCompress : faux pour les contenus déjà compressés (images, polices ...).
+     */
+    EncodedContent(const std::string &pContentType, std::string pBody, const std::string &pLastModified,
+                   bool pCompress = true)
+        : contentType(pContentType), identity(std::move(pBody)), lastModified(pLastModified)
+    {
+        etag = Tools::sha256(identity);
+        if (pCompress)
+        {
+            gzip = crow::compression::compress_string(identity, crow::compression::algorithm::GZIP);
+            deflate = crow::compression::compress_string(identity, crow::compression::algorithm::DEFLATE);
+            // une variante plus volumineuse que l'original n'est pas servie.
+            if (gzip.size() >= identity.size())
+                gzip.clear();
+            if (deflate.size() >= identity.size())
+                deflate.clear();
+        }
+    }
+    /*
+     * Construction de la réponse HTTP : 304 sans corps si le client possède déjà la variante (If-None-Match),
+     * la variante la plus adaptée à l'entête Accept-Encoding sinon.
+     * @param request : la requête du client.
+     * @param cacheControl : valeur de l'entête Cache-Control.
+     * @return la réponse.
+     */
+    crow::response respond(const crow::request &request, const std::string &cacheControl) const
+    {
+        const std::string &acceptEncoding = request.get_header_value("Accept-Encoding");
+        const std::string *body = &identity;
+        std::string encoding;
+        if (!gzip.empty() && Tools::acceptsEncoding(acceptEncoding, "gzip"))
+        {
+            body = &gzip;
+            encoding = "gzip";
+        }
+        else if (!deflate.empty() && Tools::acceptsEncoding(acceptEncoding, "deflate"))
+        {
+            body = &deflate;
+            encoding = "deflate";
+        }
+        // chaque représentation a son propre ETag fort.
+        std::string representationEtag = "\"" + etag + (encoding.empty() ? "" : "-" + encoding) + "\"";
+
+        crow::response response;
+        response.set_header("ETag", representationEtag);
+        response.set_header("Last-Modified", lastModified);
+        response.set_header("Cache-Control", cacheControl);
+        if (!gzip.empty() || !deflate.empty())
+            response.set_header("Vary", "Accept-Encoding");
+        if (Tools::etagMatches(request.get_header_value("If-None-Match"), representationEtag))
+        {
+            response.code = 304;
+            return response;
+        }
+        response.set_header("Content-Type", contentType);
+        if (!encoding.empty())
+            response.set_header("Content-Encoding", encoding);
+        response.body = *body;
+        return response;
+    }
+};
+#endif
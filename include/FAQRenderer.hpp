@@ -0,0 +1,160 @@
+#ifndef FAQ_FAQRENDERER_HPP
+#define FAQ_FAQRENDERER_HPP
+#include "CachedDataAccess.hpp"
+#include "CompiledTemplate.hpp"
+#include "FAQRow.hpp"
+#include "FAQPageTemplate.hpp"
+#include "FAQSearchTemplate.hpp"
+#include "FAQSuggestTemplate.hpp"
+#include "FAQTemplate.hpp"
+#include <span>
+#include <string>
+#include <string_view>
+/*
+ * Rendu direct de la page de FAQ, sans passer par crow::json::wvalue ni par l'interprétation du template.
+ * Les templates faq*.mustache.html sont compilés en code C++ (FAQTemplate.hpp, FAQPageTemplate.hpp ..., générés par
+ * tools/mustache2cpp lors du build) qui écrit directement les champs des FAQRow de la photographie dans le tampon de
+ * sortie.
+ * Ce rendu est sélectionné par "renderer":"direct" dans config.json, le rendu mustache interprété restant celui par
+ * défaut (rechargement à chaud du template pendant le développement).
+ */
+class FAQRenderer
+{
+  public:
+    /*
+     * Rendu de la page.
+     * @param snapshot : photographie des Q/R validées.
+     * @param askQuestion : affichage du formulaire de saisie de question.
+     * @param captchaClient : clé client recaptcha.
+     * @param pageSize : nombre de Q/R rendues dans la page, les suivantes sont chargées par /faq/page/{n}
+     * (0 = toutes).
+     * @return le html de la page.
+     */
+    static std::string render(const FAQSnapshot &snapshot, bool askQuestion, const std::string &captchaClient,
+                              std::size_t pageSize = 0)
+    {
+        std::span<const FAQRow> rows(snapshot.rows);
+        bool hasNextPage = pageSize != 0 && rows.size() > pageSize;
+        if (hasNextPage)
+            rows = rows.first(pageSize);
+
+        std::string out;
+        out.reserve(estimateSize(rows) + FAQTemplate::textSize + FAQTemplate::askQuestionTextSize);
+        FAQTemplate::render(out, View{rows, hasNextPage ? 2u : 0u, askQuestion, captchaClient,
+                                      snapshot.version != 0 ? std::to_string(snapshot.rows.size()) : ""});
+        return out;
+    }
+    /*
+     * Rendu d'un fragment de page (sections de Q/R) pour le chargement progressif par htmx.
+     * @param rows : Q/R de la page.
+     * @param nextPage : numéro de la page suivante (0 = dernière page).
+     * @return le html du fragment.
+     */
+    static std::string renderPage(std::span<const FAQRow> rows, unsigned int nextPage)
+    {
+        std::string out;
+        out.reserve(estimateSize(rows) + FAQPageTemplate::textSize + FAQPageTemplate::hasNextPageTextSize);
+        FAQPageTemplate::render(out, View{rows, nextPage, false, {}, {}});
+        return out;
+    }
+    /*
+     * Rendu des résultats d'une recherche.
+     * @param rows : Q/R trouvées, par ordre de pertinence.
+     * @return le html du fragment.
+     */
+    static std::string renderSearch(std::span<const FAQRow> rows)
+    {
+        std::string out;
+        out.reserve(estimateSize(rows) + FAQSearchTemplate::textSize + FAQSearchTemplate::resultsTextSize);
+        FAQSearchTemplate::render(out, View{rows, 0, false, {}, {}});
+        return out;
+    }
+    /*
+     * Rendu des suggestions de questions pendant la saisie.
+     * @param rows : Q/R suggérées.
+     * @return le html du fragment (éléments de liste).
+     */
+    static std::string renderSuggestions(std::span<const FAQRow> rows)
+    {
+        std::string out;
+        std::size_t size = FAQSuggestTemplate::textSize;
+        for (const auto &row : rows)
+            size += FAQSuggestTemplate::suggestionsTextSize + 16 + row.QUESTION.size() + row.QUESTION.size() / 8;
+        out.reserve(size);
+        FAQSuggestTemplate::render(out, View{rows, 0, false, {}, {}});
+        return out;
+    }
+
+  private:
+    /*
+     * Vue fournissant au template compilé les valeurs de chaque balise.
+     */
+    struct View
+    {
+        std::span<const FAQRow> rows;
+        unsigned int nextPageNumber;
+        bool showAskQuestion;
+        std::string_view captchaClientKey;
+        std::string questionCount;
+
+        std::span<const FAQRow> allQr(CompiledTemplate::Root) const
+        {
+            return rows;
+        }
+        std::span<const FAQRow> results(CompiledTemplate::Root) const
+        {
+            return rows;
+        }
+        std::span<const FAQRow> suggestions(CompiledTemplate::Root) const
+        {
+            return rows;
+        }
+        std::string rowid(const FAQRow &row) const
+        {
+            return std::to_string(row.ROWID);
+        }
+        std::string_view question(const FAQRow &row) const
+        {
+            return row.QUESTION;
+        }
+        // la réponse est volontairement non échappée (html autorisé, cf {{{reponse}}}).
+        std::string_view reponse(const FAQRow &row) const
+        {
+            return row.REPONSE;
+        }
+        bool hasNextPage(CompiledTemplate::Root) const
+        {
+            return nextPageNumber != 0;
+        }
+        std::string nextPage(CompiledTemplate::Root) const
+        {
+            return std::to_string(nextPageNumber);
+        }
+        bool askQuestion(CompiledTemplate::Root) const
+        {
+            return showAskQuestion;
+        }
+        // le nombre de questions n'est connu qu'une fois la photographie chargée.
+        std::string_view numQuestion(CompiledTemplate::Root) const
+        {
+            return questionCount;
+        }
+        std::string_view captchaClient(CompiledTemplate::Root) const
+        {
+            return captchaClientKey;
+        }
+    };
+    /*
+     * Estimation de la taille des sections de Q/R afin d'allouer le tampon de sortie une seule fois.
+     */
+    static std::size_t estimateSize(std::span<const FAQRow> rows)
+    {
+        std::size_t size = 256;
+        for (const auto &row : rows)
+            // marge pour les identifiants et l'échappement de la question.
+            size += FAQTemplate::allQrTextSize + 40 + row.QUESTION.size() + row.QUESTION.size() / 8 +
+                    row.REPONSE.size();
+        return size;
+    }
+};
+#endif
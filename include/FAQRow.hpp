@@ -9,5 +9,7 @@ struct FAQRow
     std::string DATE_AJOUT_QUESTION;
     std::string DATE_AJOUT_REPONSE;
     bool REPONSE_VALIDE;
+
+    bool operator==(const FAQRow &) const = default;
 };
 #endif
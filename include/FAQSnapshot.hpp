@@ -0,0 +1,20 @@
+#ifndef FAQ_FAQSNAPSHOT_HPP
+#define FAQ_FAQSNAPSHOT_HPP
+#include "FAQRow.hpp"
+#include <cstdint>
+#include <ctime>
+#include <vector>
+/*
+ * Photographie immuable des Q/R validées à un instant donné.
+ * Une fois publiée elle n'est plus jamais modifiée, elle peut donc être lue sans verrou par tous les threads.
+ */
+struct FAQSnapshot
+{
+    // Q/R validées.
+    std::vector<FAQRow> rows;
+    // numéro de version, incrémenté à chaque changement de contenu (0 = aucune donnée chargée).
+    uint64_t version{0};
+    // moment (secondes depuis 01/01/1970) du dernier changement de contenu.
+    std::time_t lastModified{0};
+};
+#endif
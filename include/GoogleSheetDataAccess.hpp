@@ -1,11 +1,16 @@
 #ifndef FAQ_GOOGLESHEETDATAACCESS_HPP
 #define FAQ_GOOGLESHEETDATAACCESS_HPP
-#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "AccessTokenProvider.hpp"
+#include "HttpClientPool.hpp"
 #include "IDataAccess.hpp"
+#include "SheetRowsParser.hpp"
+#include "SingleFlight.hpp"
 #include "Tools.hpp"
-#include "cpp-httplib/httplib.h"
 #include "json/json.hpp"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
 using json = nlohmann::json;
 /*
  * Classe d'accès aux données s'appuyant sur google sheets (excel).
@@ -21,43 +26,84 @@ class GoogleSheetDataAccess : public IDataAccess
      * @param pPrivateKey : clé privée permettant de signer le jeton JWT d'accès OAUTH2 en écriture.
      * @param pServiceAccount : Adresse mail du service account permettant l'accès en écriture au document.
      * @param pFields : champ de cellules de mise à jour (A1:G1)
+     * @param pSheetsUrl : adresse de l'API sheets (modifiable pour tester contre un serveur local).
+     * @param pDriveUrl : adresse de l'API drive, utilisée pour détecter les modifications de la feuille.
+     * @param pOAuthUrl : adresse du serveur d'authentification oauth2.
+     * @param pChunkRows : nombre de lignes par plage lorsque la feuille est lue par morceaux en parallèle (0 pour
+     * toujours la lire en une seule fois).
      */
     GoogleSheetDataAccess(const std::string &pSpreadsheetId, const std::string &pApiKey, const std::string &pTab,
                           const std::string &pPrivateKey, const std::string &pServiceAccount,
-                          const std::string &pFields)
-        : mSpreadsheetId(pSpreadsheetId), mApiKey(pApiKey), mTab(pTab), mPrivateKey(pPrivateKey),
-          mServiceAccount(pServiceAccount), mFields(pFields)
+                          const std::string &pFields, const std::string &pSheetsUrl = "https://sheets.googleapis.com",
+                          const std::string &pDriveUrl = "https://www.googleapis.com",
+                          const std::string &pOAuthUrl = "https://oauth2.googleapis.com",
+                          std::size_t pChunkRows = 2000)
+        : mSheetsClients(pSheetsUrl, 8, std::chrono::seconds(30), std::chrono::seconds(60)),
+          mDriveClients(pDriveUrl, 2, std::chrono::seconds(5), std::chrono::seconds(10)),
+          mAccessToken(pOAuthUrl, pServiceAccount, pPrivateKey, "https://www.googleapis.com/auth/spreadsheets"),
+          mSpreadsheetId(pSpreadsheetId), mApiKey(pApiKey), mTab(pTab), mFields(pFields), mChunkRows(pChunkRows)
     {
     }
 
     virtual bool createQuestion(const std::string &question, unsigned int numQuestion = 0)
     {
-        // Mise à jour SI NECESSAIRE du jeton d'accès.
-        //  Le jeton généré est valable 30 minutes on évite donc de le renouveller si ce n'est
-        //  pas nécessaire.
-        majAccessToken();
+        return createQuestions({{question, numQuestion}}).created == 1;
+    }
+    /*
+     * Ajout de toutes les questions en un seul appel à l'API (une ligne par question) : toutes sont créées ou aucune.
+     * Une erreur 4xx autre qu'un problème d'authentification (401, 403), de délai (408) ou de quota (429) signifie
+     * que la requête elle-même est refusée.
+     */
+    virtual CreatedQuestions createQuestions(const std::vector<NewQuestion> &questions)
+    {
+        // jeton d'accès courant, renouvelé en tâche de fond avant son expiration (obtenu immédiatement s'il n'a pas
+        // encore pu l'être).
+        auto accessToken = mAccessToken.getToken();
+        if (accessToken->empty())
+            accessToken = mAccessToken.fetchToken();
+        if (accessToken->empty())
+        {
+            std::cout << "ajout des questions impossible : jeton d'accès oauth2 indisponible" << std::endl;
+            return {};
+        }
 
-        // Nouvelle question au format JSON.
-        json nouvelleQuestion;
+        // Nouvelles questions au format JSON.
+        json nouvellesQuestions;
         // on spécifie la range (tab+fields) en supprimant le formattage HTML des espaces (%20) éventuels.
-        nouvelleQuestion["range"] = std::regex_replace(mTab, std::regex("%20"), " ") + "!" + mFields;
-        // on spếcifie que l'on va fournir une ligne entière.
-        nouvelleQuestion["majorDimension"] = "ROWS";
-        // la ligne de la nouvelle question.
-        nouvelleQuestion["values"][0] =
-            json::array({numQuestion, question, "", "Rédaction", "Question issue du site", ""});
-        std::cout << "New question with : " << nouvelleQuestion.dump() << std::endl;
+        nouvellesQuestions["range"] = std::regex_replace(mTab, std::regex("%20"), " ") + "!" + mFields;
+        // on spếcifie que l'on va fournir des lignes entières.
+        nouvellesQuestions["majorDimension"] = "ROWS";
+        // une ligne par nouvelle question.
+        nouvellesQuestions["values"] = json::array();
+        for (const auto &newQuestion : questions)
+            nouvellesQuestions["values"].push_back(json::array(
+                {newQuestion.numQuestion, newQuestion.question, "", "Rédaction", "Question issue du site", ""}));
+        std::cout << "New questions with : " << nouvellesQuestions.dump() << std::endl;
         // on spécifie les headers de la requete dont le jeton d'acces oauth2.
         const httplib::Headers headers = {{"Content-Type", "application/json"},
-                                          {"Authorization", "Bearer " + mAccessToken}};
-        // appel de la méthode Rest API avec le body contenant la nouvelle question.
-        auto res = mHttpClient.Post("/v4/spreadsheets/" + mSpreadsheetId + "/values/" + mTab + "!" + mFields +
-                                        ":append?valueInputOption=RAW&insertDataOption=INSERT_ROWS",
-                                    headers, nouvelleQuestion.dump(), "application/json");
+                                          {"Authorization", "Bearer " + *accessToken}};
+        // appel de la méthode Rest API avec le body contenant les nouvelles questions.
+        // en cas d'échec les questions restent dans le journal (QuestionSpool) et sont retransmises plus tard.
+        auto res = mSheetsClients.send([&](httplib::Client &client) {
+            return client.Post("/v4/spreadsheets/" + mSpreadsheetId + "/values/" + mTab + "!" + mFields +
+                                   ":append?valueInputOption=RAW&insertDataOption=INSERT_ROWS",
+                               headers, nouvellesQuestions.dump(), "application/json");
+        });
+        if (!res)
+        {
+            std::cout << "ajout des questions impossible : " << httplib::to_string(res.error()) << std::endl;
+            return {};
+        }
         std::cout << res->status << std::endl;
         std::cout << res->reason << std::endl;
-        // on retourne si le status == 200 (ok) ou pas.
-        return (res->status == 200);
+        // jeton refusé (révoqué, horloge décalée ...) : un nouveau jeton est demandé pour le prochain essai.
+        if (res->status == 401)
+            mAccessToken.requestRefresh();
+        if (res->status == 200)
+            return {questions.size(), false};
+        bool transient = res->status == 401 || res->status == 403 || res->status == 408 || res->status == 429 ||
+                         res->status >= 500;
+        return {0, !transient};
     }
     /*
      * Pas d'update de question via le site pour  GoogleSpreadSheet on utilisera l'ihm de google.
@@ -74,109 +120,186 @@ class GoogleSheetDataAccess : public IDataAccess
         return false;
     }
 
+    /*
+     * Les Q/R non validées sont écartées pendant la lecture de la réponse, sans être conservées.
+     */
     virtual std::optional<std::vector<FAQRow>> getAllValidated()
     {
-        // On récupère toutes les Q/R.
-        auto allQR = getAll();
-        if (allQR.has_value())
+        return fetchRows(true);
+    }
+    virtual std::optional<std::vector<FAQRow>> getAll()
+    {
+        return fetchRows(false);
+    }
+    /*
+     * Version du fichier selon l'API drive (quelques dizaines d'octets, contre la feuille entière pour batchGet).
+     * La feuille doit être lisible avec l'API_KEY (partagée par lien), sinon null est retourné et la feuille est
+     * relue à chaque rafraîchissement.
+     */
+    virtual std::optional<std::string> getChangeToken()
+    {
+        auto res = mDriveClients.send([this](httplib::Client &client) {
+            return client.Get("/drive/v3/files/" + mSpreadsheetId + "?fields=version,modifiedTime&key=" + mApiKey);
+        });
+        if (!res || res->status != 200)
         {
-            auto vQr = allQR.value();
-            // On efface les Q/R qui n'ont pas la réponse valide.
-            std::erase_if(vQr, [](const auto &row) { return !row.REPONSE_VALIDE; });
-            return {vQr};
+            std::cout << "version de la feuille indisponible : "
+                      << (res ? std::to_string(res->status) : httplib::to_string(res.error())) << std::endl;
+            return std::nullopt;
         }
-        return std::nullopt;
+        auto file = json::parse(res->body, nullptr, false);
+        if (file.is_discarded() || !file.contains("version"))
+            return std::nullopt;
+        return {file.value("version", "") + "/" + file.value("modifiedTime", "")};
     }
-    virtual std::optional<std::vector<FAQRow>> getAll()
+
+  private:
+    /*
+     * Lecture des lignes de la feuille, les lectures simultanées identiques ne font qu'un seul appel à l'API.
+     * @param onlyValidated : ne conserve que les Q/R validées.
+     * @return les Q/R ou null en cas d'erreur.
+     */
+    std::optional<std::vector<FAQRow>> fetchRows(bool onlyValidated)
     {
-        // Appel de l'API Google avec l'API_KEY fournie.
+        return mFetches.run(onlyValidated, [this, onlyValidated]() { return requestRows(onlyValidated); });
+    }
+    /*
+     * Lecture de toutes les lignes de la feuille. Une grande feuille est découpée en plages de mChunkRows lignes,
+     * téléchargées et analysées en parallèle puis remises bout à bout dans l'ordre de la feuille.
+     * Seules les MAX_ROWS premières lignes de Q/R de la feuille sont lues, toutes plages confondues.
+     * @param onlyValidated : ne conserve que les Q/R validées.
+     * @return les Q/R ou null en cas d'erreur (sur l'une des plages).
+     */
+    std::optional<std::vector<FAQRow>> requestRows(bool onlyValidated)
+    {
+        auto rowCount = mChunkRows > 0 ? getRowCount() : std::nullopt;
+        // petite feuille (ou taille inconnue) : un seul appel.
+        if (!rowCount.has_value() || rowCount.value() <= mChunkRows)
+            return requestRange(mTab, onlyValidated, true);
 
-        auto res = mHttpClient.Get("/v4/spreadsheets/" + mSpreadsheetId + "/values:batchGet?ranges=" + mTab +
-                                   "&key=" + mApiKey);
-        std::cout << res->body << std::endl;
-        if (!res->body.empty())
-        {
-            std::vector<FAQRow> retour;
-            // récupération au format json du body de la réponse
-            // contient l'ensemble des lignes du fichier excel.
-            json sheet = json::parse(res->body);
-            // extraction des lignes.
-            auto lines = sheet["valueRanges"][0]["values"];
-            if (!lines.empty())
-            {
-                // on efface l'entête qui contient l'intitulé des colonnes. (cad le 1er élément du vecteur)
-                lines.erase(lines.begin());
+        // la ligne d'entête s'ajoute aux MAX_ROWS lignes de Q/R.
+        std::size_t lastRow = std::min(rowCount.value(), MAX_ROWS + 1);
+        if (lastRow < rowCount.value())
+            std::cout << rowCount.value() - lastRow << " lignes ignorées au delà de " << MAX_ROWS << std::endl;
+        std::vector<std::string> ranges;
+        for (std::size_t first = 1; first <= lastRow; first += mChunkRows)
+            ranges.push_back(mTab + "!A" + std::to_string(first) + ":D" +
+                             std::to_string(std::min(first + mChunkRows - 1, lastRow)));
+        std::cout << "google sheets : lecture de " << rowCount.value() << " lignes en " << ranges.size()
+                  << " plages" << std::endl;
 
-                for (auto &line : lines)
+        // chaque thread prend la prochaine plage non lue, seule la première contient l'entête.
+        std::vector<std::optional<std::vector<FAQRow>>> chunks(ranges.size());
+        std::atomic<std::size_t> next{0};
+        auto worker = [&]() {
+            for (std::size_t i = next++; i < ranges.size(); i = next++)
+            {
+                try
                 {
-                    // pour chaque ligne on va créer un objet FAQRow et affecter les attributs à partir de la ligne
-                    // json.
-                    try
-                    {
-                        FAQRow row;
-                        std::string rowidstr = line[0];
-                        // Cette instruction peut échouer si la string fournie ne peut être convertie
-                        // la ligne sera ignorée par le catch
-                        row.ROWID = std::stoi(rowidstr);
-                        row.QUESTION = line[1];
-                        row.REPONSE = line[2];
-                        row.REPONSE_VALIDE = line[3] == "Validé" ? true : false;
-                        // on ajoute la ligne au retour.
-                        retour.push_back(row);
-                    } // on catch les éventuelles exceptions de conversion.
-                    catch (const std::invalid_argument &e)
-                    {
-                        std::cout << "impossible d'instancier objet FAQRow : " << e.what() << " : " << line[0] << "\n";
-                    }
-                    catch (const std::out_of_range &e)
-                    {
-                        std::cout << "impossible d'instancier objet FAQRow : " << e.what() << " : " << line[0] << "\n";
-                    }
+                    chunks[i] = requestRange(ranges[i], onlyValidated, i == 0);
+                }
+                catch (const std::exception &e)
+                {
+                    std::cout << "lecture de la plage " << ranges[i] << " impossible : " << e.what() << std::endl;
                 }
             }
+        };
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < std::min(ranges.size(), MAX_PARALLEL_CHUNKS); i++)
+            workers.emplace_back(worker);
+        worker();
+        for (auto &thread : workers)
+            thread.join();
 
-            return {retour};
+        // une plage manquante rendrait la FAQ incomplète : la lecture entière échoue.
+        std::size_t total = 0;
+        for (const auto &chunk : chunks)
+        {
+            if (!chunk.has_value())
+                return std::nullopt;
+            total += chunk->size();
+        }
+        std::vector<FAQRow> rows;
+        rows.reserve(std::min(total, MAX_ROWS));
+        for (auto &chunk : chunks)
+            std::move(chunk->begin(), chunk->begin() + std::min(chunk->size(), MAX_ROWS - rows.size()),
+                      std::back_inserter(rows));
+        return {std::move(rows)};
+    }
+    /*
+     * Nombre de lignes de l'onglet selon l'API sheets (métadonnées uniquement, sans le contenu des cellules).
+     * @return le nombre de lignes ou null s'il n'a pas pu être obtenu.
+     */
+    std::optional<std::size_t> getRowCount()
+    {
+        auto res = mSheetsClients.send([this](httplib::Client &client) {
+            return client.Get("/v4/spreadsheets/" + mSpreadsheetId +
+                              "?fields=sheets.properties(title,gridProperties.rowCount)&key=" + mApiKey);
+        });
+        if (!res || res->status != 200)
+            return std::nullopt;
+        auto spreadsheet = json::parse(res->body, nullptr, false);
+        if (spreadsheet.is_discarded() || !spreadsheet.is_object())
+            return std::nullopt;
+        std::string title = std::regex_replace(mTab, std::regex("%20"), " ");
+        for (const auto &sheet : spreadsheet.value("sheets", json::array()))
+        {
+            auto properties = sheet.value("properties", json::object());
+            if (properties.value("title", "") == title)
+                return properties.value("gridProperties", json::object()).value("rowCount", std::size_t{0});
         }
-
         return std::nullopt;
     }
-
-  private:
     /*
-     * Méthode de mise à jour du jeton d'accès oauth2.
+     * Appel de l'API Google (avec l'API_KEY fournie) et lecture en flux des lignes d'une plage de la feuille.
+     * @param range : plage à lire (onglet entier ou onglet!A1:D2000).
+     * @param onlyValidated : ne conserve que les Q/R validées.
+     * @param withHeader : la plage commence par la ligne d'entête.
+     * @return les Q/R ou null en cas d'erreur.
      */
-    void majAccessToken()
+    std::optional<std::vector<FAQRow>> requestRange(const std::string &range, bool onlyValidated, bool withHeader)
     {
-        // Si le jeton est invalide ou absent.
-        if (Tools::currentTimestamp() >= mAccessTokenTimestamp || mAccessToken.empty())
+        auto res = mSheetsClients.send([this, &range](httplib::Client &client) {
+            return client.Get("/v4/spreadsheets/" + mSpreadsheetId + "/values:batchGet?ranges=" + range +
+                              "&key=" + mApiKey);
+        });
+        // aucune réponse (réseau indisponible, délai dépassé, disjoncteur ouvert ...) : le cache conserve la dernière
+        // photographie.
+        if (!res)
         {
-            // on génère un nouveau jeton JWT à partir de l'adresse email de l'utilisateur et de la clé privée.
-            std::string token = Tools::JWTToken(mServiceAccount, "https://www.googleapis.com/auth/spreadsheets",
-                                                "https://oauth2.googleapis.com/token", mPrivateKey);
-            std::cout << "Token JWT : " << token << std::endl;
-            // on appelle le point d'accès permettant de récupérer un jeton d'accès oauth2 a partir du jeton JWT.
-            auto res =
-                mHttpClient.Post("https://oauth2.googleapis.com/"
-                                 "token?grant_type=urn%3Aietf%3Aparams%3Aoauth%3Agrant-type%3Ajwt-bearer&assertion=" +
-                                 token);
-            if (!res->body.empty())
-            {
-                // récupération du jeton d'accès dans le body de la réponse.
-                mAccessToken = json::parse(res->body)["access_token"];
-                // mise à jour du moment d'expiration (30 minutes dans le futur) du jeton.
-                mAccessTokenTimestamp = Tools::currentTimestamp(std::chrono::minutes(30));
-                // std::cout << "Access Token : " << mAccessToken << std::endl;
-            }
+            std::cout << "google sheets inaccessible : " << httplib::to_string(res.error()) << std::endl;
+            return std::nullopt;
         }
+        // clé refusée (400, 403), quota dépassé (429), panne (5xx) ... : le corps est un message d'erreur de google,
+        // pas une plage à analyser. Le statut est tracé avec le début du message pour distinguer ces cas.
+        if (res->status != 200)
+        {
+            std::cout << "google sheets : lecture refusée, " << res->status << " " << res->reason << " : "
+                      << res->body.substr(0, 300) << std::endl;
+            return std::nullopt;
+        }
+        std::cout << "google sheets : " << res->status << ", " << res->body.size() << " octets" << std::endl;
+        if (res->body.empty())
+            return std::nullopt;
+        // contient l'ensemble des lignes du fichier excel, converties en FAQRow sans construire d'arbre json.
+        return SheetRowsParser::parse(res->body, onlyValidated, MAX_ROWS, withHeader);
     }
-    httplib::Client mHttpClient{"https://sheets.googleapis.com"};
+    // nombre maximum de Q/R conservées pour l'ensemble de la feuille (borne la mémoire utilisée par une lecture).
+    static constexpr std::size_t MAX_ROWS = 100000;
+    // nombre maximum de plages lues simultanément (inférieur à la taille du pool mSheetsClients).
+    static constexpr std::size_t MAX_PARALLEL_CHUNKS = 4;
+
+    // connexions keep-alive vers les API sheets et drive, avec un délai maximum propre à chacune.
+    HttpClientPool mSheetsClients;
+    HttpClientPool mDriveClients;
+    // jeton d'accès oauth2 en écriture, renouvelé en tâche de fond.
+    AccessTokenProvider mAccessToken;
+    // lectures de la feuille en cours (clé : Q/R validées uniquement ou non).
+    SingleFlight<bool, std::optional<std::vector<FAQRow>>> mFetches;
     std::string mTab;
     std::string mFields;
     std::string mSpreadsheetId;
     std::string mApiKey;
-    std::string mPrivateKey;
-    std::string mServiceAccount;
-    int64_t mAccessTokenTimestamp{0};
-    std::string mAccessToken;
+    std::size_t mChunkRows;
 };
 #endif
@@ -0,0 +1,242 @@
+#ifndef FAQ_HTTPCLIENTPOOL_HPP
+#define FAQ_HTTPCLIENTPOOL_HPP
+#ifndef CPPHTTPLIB_OPENSSL_SUPPORT
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#endif
+#include "CircuitBreaker.hpp"
+#include "cpp-httplib/httplib.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+/*
+ * Pool de clients HTTP(S) keep-alive vers un même hôte.
+ * Un httplib::Client n'est pas utilisable par plusieurs threads à la fois : chaque appel emprunte un client du pool
+ * le temps de la requête, ce qui permet aux threads de Crow de travailler en parallèle tout en réutilisant les
+ * connexions TLS déjà établies. Le nombre de clients est borné, un thread attend qu'un client se libère si tous sont
+ * empruntés. Les clients inutilisés depuis trop longtemps sont fermés.
+ * Chaque requête est bornée dans le temps (connexion, lecture, écriture) et les appels passant par send() ont de plus
+ * une durée totale maximale (un serveur envoyant sa réponse goutte à goutte ne dépasse jamais le délai de lecture) et
+ * sont protégés par un disjoncteur propre à l'hôte : un service lent ou en panne ne peut pas immobiliser tous les
+ * threads.
+ */
+class HttpClientPool
+{
+  public:
+    /*
+     * Client emprunté au pool, rendu automatiquement à sa destruction.
+     */
+    class Lease
+    {
+      public:
+        Lease(HttpClientPool &pPool, std::unique_ptr<httplib::Client> pClient)
+            : mPool(&pPool), mClient(std::move(pClient))
+        {
+        }
+        Lease(Lease &&) = default;
+        Lease &operator=(Lease &&) = delete;
+        ~Lease()
+        {
+            if (mClient)
+                mPool->release(std::move(mClient));
+        }
+        httplib::Client *operator->() const
+        {
+            return mClient.get();
+        }
+        httplib::Client &operator*() const
+        {
+            return *mClient;
+        }
+
+      private:
+        HttpClientPool *mPool;
+        std::unique_ptr<httplib::Client> mClient;
+    };
+    /*
+     * Constructeur, les clients sont créés à la demande.
+     * @param pHost : schéma et hôte (https://sheets.googleapis.com).
+     * @param pMaxSize : nombre maximum de clients (donc de connexions) simultanés.
+     * @param pTimeout : délai maximum d'établissement de la connexion, puis de chaque lecture ou écriture.
+     * @param pCallTimeout : durée maximum d'un appel par send(), attente d'un client et transfert compris.
+     * @param pIdleTimeout : durée d'inutilisation au delà de laquelle un client est fermé.
+     */
+    HttpClientPool(const std::string &pHost, std::size_t pMaxSize = 8,
+                   std::chrono::seconds pTimeout = std::chrono::seconds(10),
+                   std::chrono::seconds pCallTimeout = std::chrono::seconds(30),
+                   std::chrono::seconds pIdleTimeout = std::chrono::seconds(60))
+        : mHost(pHost), mMaxSize(pMaxSize), mTimeout(pTimeout), mCallTimeout(pCallTimeout),
+          mIdleTimeout(pIdleTimeout), mBreaker(pHost)
+    {
+    }
+    HttpClientPool(const HttpClientPool &) = delete;
+    HttpClientPool &operator=(const HttpClientPool &) = delete;
+    /*
+     * Emprunt d'un client, bloquant si tous les clients sont déjà empruntés.
+     * @return le client, à conserver le temps de la requête.
+     */
+    Lease acquire()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        evictIdle();
+        mCondition.wait(lock, [this]() { return available(); });
+        return take(lock);
+    }
+    /*
+     * Requête protégée par le disjoncteur : elle échoue immédiatement (Error::Canceled) si l'hôte est considéré en
+     * panne, ou (Error::ConnectionTimeout) si aucun client ne se libère dans le délai d'une requête. La connexion est
+     * coupée si l'appel dépasse mCallTimeout, la requête échoue alors sans réponse.
+     * Une absence de réponse, une erreur 5xx ou 429 compte comme un échec de l'hôte.
+     * @param request : requête à exécuter avec le client emprunté.
+     * @return le résultat de la requête, son éventuelle exception est relancée après avoir compté un échec.
+     */
+    httplib::Result send(const std::function<httplib::Result(httplib::Client &)> &request)
+    {
+        if (!mBreaker.allow())
+            return httplib::Result(nullptr, httplib::Error::Canceled);
+        auto deadline = std::chrono::steady_clock::now() + mCallTimeout;
+        std::optional<Lease> client;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            evictIdle();
+            if (mCondition.wait_for(lock, mTimeout, [this]() { return available(); }))
+                client.emplace(take(lock));
+        }
+        if (!client.has_value())
+        {
+            mBreaker.record(false);
+            return httplib::Result(nullptr, httplib::Error::ConnectionTimeout);
+        }
+        httplib::Result res;
+        try
+        {
+            Watchdog watchdog(**client, deadline, mHost);
+            res = request(**client);
+        }
+        catch (...)
+        {
+            // l'essai d'un disjoncteur semi-ouvert doit être conclu, sinon il refuserait tous les appels suivants.
+            mBreaker.record(false);
+            throw;
+        }
+        mBreaker.record(res && res->status < 500 && res->status != 429);
+        return res;
+    }
+
+  private:
+    /*
+     * Coupure de la connexion d'un client si la requête en cours n'est pas terminée à l'échéance : Client::stop() est
+     * la seule opération de httplib utilisable depuis un autre thread pendant une requête (le socket est fermé, la
+     * lecture ou l'écriture en cours échoue). La version de httplib utilisée n'a pas de délai total (set_max_timeout).
+     */
+    class Watchdog
+    {
+      public:
+        Watchdog(httplib::Client &pClient, std::chrono::steady_clock::time_point pDeadline, const std::string &pHost)
+        {
+            mThread = std::thread([this, &pClient, pDeadline, pHost]() {
+                std::unique_lock<std::mutex> lock(mMutex);
+                if (!mCondition.wait_until(lock, pDeadline, [this]() { return mDone; }))
+                {
+                    std::cout << pHost << " : durée maximum d'appel dépassée, connexion coupée" << std::endl;
+                    pClient.stop();
+                }
+            });
+        }
+        Watchdog(const Watchdog &) = delete;
+        Watchdog &operator=(const Watchdog &) = delete;
+        ~Watchdog()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mDone = true;
+            }
+            mCondition.notify_one();
+            mThread.join();
+        }
+
+      private:
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        bool mDone{false};
+        std::thread mThread;
+    };
+    struct IdleClient
+    {
+        std::unique_ptr<httplib::Client> client;
+        std::chrono::steady_clock::time_point since;
+    };
+    /*
+     * @return vrai si un client peut être emprunté sans attendre (appelée verrou pris).
+     */
+    bool available() const
+    {
+        return !mIdle.empty() || mSize < mMaxSize;
+    }
+    /*
+     * Emprunt d'un client disponible ou création d'un nouveau client (appelée verrou pris, le verrou est relâché).
+     */
+    Lease take(std::unique_lock<std::mutex> &lock)
+    {
+        if (!mIdle.empty())
+        {
+            // le client le plus récemment rendu a le plus de chances d'avoir encore une connexion ouverte.
+            auto client = std::move(mIdle.back().client);
+            mIdle.pop_back();
+            return Lease(*this, std::move(client));
+        }
+        mSize++;
+        lock.unlock();
+        // création hors verrou, la connexion elle-même n'est établie qu'à la première requête.
+        auto client = std::make_unique<httplib::Client>(mHost);
+        client->set_keep_alive(true);
+        client->set_connection_timeout(mTimeout);
+        client->set_read_timeout(mTimeout);
+        client->set_write_timeout(mTimeout);
+        return Lease(*this, std::move(client));
+    }
+    /*
+     * Retour d'un client dans le pool.
+     */
+    void release(std::unique_ptr<httplib::Client> client)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mIdle.push_back({std::move(client), std::chrono::steady_clock::now()});
+        }
+        mCondition.notify_one();
+    }
+    /*
+     * Fermeture des clients inutilisés depuis plus de mIdleTimeout (appelée verrou pris).
+     */
+    void evictIdle()
+    {
+        auto limit = std::chrono::steady_clock::now() - mIdleTimeout;
+        // les clients sont rendus dans l'ordre chronologique : les plus anciens sont en tête.
+        auto firstRecent = mIdle.begin();
+        while (firstRecent != mIdle.end() && firstRecent->since < limit)
+            ++firstRecent;
+        mSize -= firstRecent - mIdle.begin();
+        mIdle.erase(mIdle.begin(), firstRecent);
+    }
+
+    std::string mHost;
+    std::size_t mMaxSize;
+    std::chrono::seconds mTimeout;
+    std::chrono::seconds mCallTimeout;
+    std::chrono::seconds mIdleTimeout;
+    CircuitBreaker mBreaker;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    // clients disponibles, du plus anciennement au plus récemment rendu.
+    std::vector<IdleClient> mIdle;
+    // nombre de clients existants (disponibles ou empruntés).
+    std::size_t mSize{0};
+};
+#endif
@@ -1,8 +1,30 @@
 #ifndef FAQ_IDATAACCESS_HPP
 #define FAQ_IDATAACCESS_HPP
 #include "FAQRow.hpp"
+#include <algorithm>
+#include <iterator>
 #include <optional>
+#include <string>
 #include <vector>
+/*
+ * Question posée par un visiteur, en attente de création dans le stockage.
+ */
+struct NewQuestion
+{
+    std::string question;
+    unsigned int numQuestion{0};
+};
+/*
+ * Résultat de la création d'un lot de questions.
+ */
+struct CreatedQuestions
+{
+    // nombre de questions créées, toujours les premières du lot.
+    std::size_t created{0};
+    // vrai si le stockage a refusé les questions restantes (requête invalide, contrainte non respectée ...) : les
+    // retransmettre à l'identique échouerait de nouveau. Faux pour une erreur passagère (réseau, quota ...).
+    bool permanent{false};
+};
 /*
  * Interface d'accès aux données.
  */
@@ -16,6 +38,22 @@ class IDataAccess
      * @return vrai si question ajoutée, faux sinon.
      */
     virtual bool createQuestion(const std::string &question, unsigned int numQuestion = 0) = 0;
+    /*
+     * Méthode de création de plusieurs questions en une seule opération.
+     * L'implémentation par défaut crée les questions une à une et s'arrête à la première erreur (les questions
+     * précédentes restent créées et sont comptées), les couches de données capables d'écrire par lot la
+     * redéfinissent.
+     * @param questions : questions à créer.
+     * @return le nombre de questions créées et la nature de l'éventuel échec.
+     */
+    virtual CreatedQuestions createQuestions(const std::vector<NewQuestion> &questions)
+    {
+        CreatedQuestions result;
+        while (result.created < questions.size() &&
+               createQuestion(questions[result.created].question, questions[result.created].numQuestion))
+            result.created++;
+        return result;
+    }
     /*
      * Méthode de mise à jour d'une question/réponse existante.
      * @param rowid : identifiant unique de la question.
@@ -39,6 +77,45 @@ class IDataAccess
      * @return optional avec les questions/réponses ou null;
      */
     virtual std::optional<std::vector<FAQRow>> getAll() = 0;
+    /*
+     * Méthode permettant de récupérer une page des question/réponses avec le statut validé.
+     * L'implémentation par défaut découpe le résultat de getAllValidated, les couches de données capables de
+     * paginer nativement la redéfinissent.
+     * @param offset : nombre de question/réponses à ignorer.
+     * @param limit : nombre maximum de question/réponses retournées.
+     * @return optional avec les question/réponses de la page ou null.
+     */
+    virtual std::optional<std::vector<FAQRow>> getValidatedPage(std::size_t offset, std::size_t limit)
+    {
+        auto allQr = getAllValidated();
+        if (!allQr.has_value())
+            return std::nullopt;
+        auto &rows = allQr.value();
+        auto first = rows.begin() + std::min(offset, rows.size());
+        auto last = first + std::min(limit, static_cast<std::size_t>(rows.end() - first));
+        return {std::vector<FAQRow>(std::make_move_iterator(first), std::make_move_iterator(last))};
+    }
+    /*
+     * Méthode permettant de savoir à moindre coût si les données ont changé, sans les relire.
+     * @return un jeton qui change à chaque modification des données (version, date de modification ...), ou null
+     * si la couche de données ne sait pas le fournir (les données doivent alors être relues).
+     */
+    virtual std::optional<std::string> getChangeToken()
+    {
+        return std::nullopt;
+    }
+    /*
+     * Méthode de recherche plein texte dans les question/réponses avec le statut validé, pour les couches de données
+     * qui savent la faire elles-mêmes (l'implémentation par défaut ne la supporte pas).
+     * @param query : texte recherché.
+     * @param limit : nombre maximum de question/réponses retournées.
+     * @return les question/réponses de la plus à la moins pertinente (la réponse pouvant être réduite à un extrait
+     * autour des termes trouvés), ou null si la recherche n'est pas supportée ou a échoué.
+     */
+    virtual std::optional<std::vector<FAQRow>> search(const std::string &, std::size_t)
+    {
+        return std::nullopt;
+    }
     virtual ~IDataAccess()
     {
     }
@@ -0,0 +1,92 @@
+#ifndef FAQ_PAGECACHE_HPP
+#define FAQ_PAGECACHE_HPP
+#include "EncodedContent.hpp"
+#include "Tools.hpp"
+#include <crow.h>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+/*
+ * Page rendue conservée en cache.
+ */
+struct CachedPage
+{
+    // contenu html de la page et ses variantes compressées.
+    EncodedContent content;
+    // versions des données et des templates ayant servi au rendu.
+    uint64_t dataVersion{0};
+    uint64_t templateVersion{0};
+};
+/*
+ * Cache des pages rendues (html ou json).
+ * Chaque variante d'une page (formulaire de question affiché ou non ...) est rendue et compressée une seule fois par
+ * version des données et des templates, puis servie telle quelle avec un ETag permettant de répondre 304 aux clients
+ * qui possèdent déjà la page.
+ * Toutes les variantes sont rendues à partir de la même photographie : dès qu'une page d'une nouvelle version des
+ * données est mise en cache, celles des versions précédentes (qui ne seront plus servies) sont retirées.
+ */
+class PageCache
+{
+  public:
+    /*
+     * Récupère une variante de page, en la rendant si la version en cache est périmée ou absente.
+     * @param variant : nom de la variante.
+     * @param dataVersion : version des données.
+     * @param templateVersion : version des templates.
+     * @param lastModified : moment de la dernière modification des données.
+     * @param render : fonction de rendu appelée en cas d'absence en cache.
+     * @param contentType : type MIME du contenu rendu.
+     * @return la page en cache.
+     */
+    std::shared_ptr<const CachedPage> get(const std::string &variant, uint64_t dataVersion, uint64_t templateVersion,
+                                          std::time_t lastModified, const std::function<std::string()> &render,
+                                          const std::string &contentType = "text/html")
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(mMutex);
+            auto found = mPages.find(variant);
+            if (found != mPages.end() && found->second->dataVersion == dataVersion &&
+                found->second->templateVersion == templateVersion)
+                return found->second;
+        }
+        // rendu et compression hors verrou, les autres variantes restent servies pendant ce temps.
+        auto page = std::make_shared<CachedPage>(
+            CachedPage{EncodedContent(contentType, render(), Tools::httpDate(lastModified)), dataVersion,
+                       templateVersion});
+
+        std::unique_lock<std::shared_mutex> lock(mMutex);
+        if (dataVersion > mDataVersion)
+        {
+            // Q/R supprimées, pages disparues ... : rien ne doit rester d'une version antérieure.
+            mDataVersion = dataVersion;
+            std::erase_if(mPages, [dataVersion](const auto &entry) { return entry.second->dataVersion < dataVersion; });
+        }
+        // une page rendue à partir d'une photographie déjà remplacée est servie mais pas conservée.
+        if (dataVersion == mDataVersion)
+            mPages[variant] = page;
+        return page;
+    }
+    /*
+     * Construction de la réponse HTTP pour une page en cache.
+     * @param request : la requête du client.
+     * @param page : la page en cache.
+     * @return la réponse.
+     */
+    static crow::response respond(const crow::request &request, const CachedPage &page)
+    {
+        // le navigateur doit revalider la page à chaque affichage, ce qui ne coûte qu'un 304.
+        return page.content.respond(request, "no-cache");
+    }
+
+  private:
+    std::shared_mutex mMutex;
+    // dernière page rendue pour chaque variante.
+    std::map<std::string, std::shared_ptr<const CachedPage>> mPages;
+    // version des données la plus récente mise en cache.
+    uint64_t mDataVersion{0};
+};
+#endif
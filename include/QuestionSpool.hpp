@@ -0,0 +1,240 @@
+#ifndef FAQ_QUESTIONSPOOL_HPP
+#define FAQ_QUESTIONSPOOL_HPP
+#include "IDataAccess.hpp"
+#include "json/json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+using json = nlohmann::json;
+/*
+ * File d'attente durable des questions posées par les visiteurs.
+ * Une question est d'abord écrite (et synchronisée sur disque) dans un fichier journal, ce qui permet de répondre
+ * immédiatement au visiteur. Un thread dédié transmet ensuite les questions en attente à la couche de données, par
+ * lots (un seul appel pour plusieurs questions), en réessayant avec un délai croissant en cas d'échec passager.
+ * Seules les questions non créées sont retransmises. Un lot refusé par le stockage est retransmis question par question
+ * pour isoler celle qui pose problème, qui est alors écartée dans le fichier <journal>.rejected au lieu de bloquer
+ * les suivantes.
+ * Le journal ne contient que des ajouts : une ligne {"id":n,"question":...,"numQuestion":...} par question et une
+ * ligne {"done":n} par question transmise. Il est vidé dès que plus aucune question n'est en attente, et relu au
+ * démarrage pour transmettre les questions qui ne l'avaient pas encore été.
+ */
+class QuestionSpool
+{
+  public:
+    /*
+     * Constructeur, relit le journal puis démarre le thread de transmission.
+     * @param pDataAccess : couche de données dans laquelle les questions sont créées.
+     * @param pPath : chemin du fichier journal.
+     * @param pMaxBatch : nombre maximum de questions transmises en un appel.
+     */
+    QuestionSpool(IDataAccess &pDataAccess, const std::string &pPath, std::size_t pMaxBatch = 50)
+        : mDataAccess(pDataAccess), mPath(pPath), mMaxBatch(pMaxBatch)
+    {
+        replay();
+        mFile = ::open(mPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0640);
+        if (mFile < 0)
+            std::cout << "ouverture du journal des questions impossible : " << mPath << std::endl;
+        mWriterThread = std::thread([this]() { run(); });
+    }
+    QuestionSpool(const QuestionSpool &) = delete;
+    QuestionSpool &operator=(const QuestionSpool &) = delete;
+
+    ~QuestionSpool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mCondition.notify_all();
+        if (mWriterThread.joinable())
+            mWriterThread.join();
+        // les questions encore en attente restent dans le journal et seront transmises au prochain démarrage.
+        if (mFile >= 0)
+            ::close(mFile);
+    }
+    /*
+     * Enregistrement d'une question, qui sera transmise en tâche de fond.
+     * @param question : contenu de la question.
+     * @param numQuestion : numéro de la question.
+     * @return vrai si la question est enregistrée dans le journal, faux sinon.
+     */
+    bool submit(const std::string &question, unsigned int numQuestion)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            json entry = {{"id", mNextId}, {"question", question}, {"numQuestion", numQuestion}};
+            if (!append(entry))
+                return false;
+            mPending.push_back({mNextId++, {question, numQuestion}});
+        }
+        mCondition.notify_all();
+        return true;
+    }
+
+  private:
+    struct Entry
+    {
+        uint64_t id;
+        NewQuestion question;
+    };
+    /*
+     * Relecture du journal : les questions sans ligne "done" correspondante sont remises en attente.
+     */
+    void replay()
+    {
+        std::ifstream file(mPath);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            // une ligne incomplète (arrêt brutal pendant l'écriture) est ignorée.
+            json entry = json::parse(line, nullptr, false);
+            if (entry.is_discarded() || !entry.is_object())
+                continue;
+            if (entry.contains("done"))
+            {
+                uint64_t id = entry.value("done", uint64_t{0});
+                std::erase_if(mPending, [id](const Entry &pending) { return pending.id == id; });
+            }
+            else if (entry.contains("id"))
+            {
+                uint64_t id = entry.value("id", uint64_t{0});
+                mPending.push_back({id, {entry.value("question", ""), entry.value("numQuestion", 0u)}});
+                mNextId = std::max(mNextId, id + 1);
+            }
+        }
+        if (!mPending.empty())
+            std::cout << mPending.size() << " questions en attente reprises depuis " << mPath << std::endl;
+    }
+    /*
+     * Ajout d'une ligne au journal, synchronisée sur disque (appelée verrou pris).
+     */
+    bool append(const json &entry)
+    {
+        if (mFile < 0)
+            return false;
+        std::string line = entry.dump() + "\n";
+        if (::write(mFile, line.data(), line.size()) != static_cast<ssize_t>(line.size()) || ::fdatasync(mFile) != 0)
+        {
+            std::cout << "écriture dans le journal des questions impossible : " << mPath << std::endl;
+            return false;
+        }
+        return true;
+    }
+    /*
+     * Boucle du thread de transmission.
+     */
+    void run()
+    {
+        std::chrono::seconds backoff(0);
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (!mStop)
+        {
+            if (backoff.count() > 0)
+                mCondition.wait_for(lock, backoff, [this]() { return mStop; });
+            else
+                mCondition.wait(lock, [this]() { return mStop || !mPending.empty(); });
+            if (mStop || mPending.empty())
+                continue;
+
+            // les questions arrivées pendant l'appel précédent ou l'attente sont regroupées en un seul lot, sauf pour
+            // les questions d'un lot refusé, transmises une à une.
+            std::size_t count = std::min(mIsolated > 0 ? 1 : mMaxBatch, mPending.size());
+            std::vector<Entry> batch(mPending.begin(), mPending.begin() + count);
+            lock.unlock();
+
+            std::vector<NewQuestion> questions;
+            for (const auto &entry : batch)
+                questions.push_back(entry.question);
+            CreatedQuestions result;
+            try
+            {
+                result = mDataAccess.createQuestions(questions);
+            }
+            catch (const std::exception &e)
+            {
+                std::cout << "transmission des questions impossible : " << e.what() << std::endl;
+            }
+
+            lock.lock();
+            // les questions créées ne sont jamais retransmises, même si la suite du lot a échoué.
+            std::size_t done = std::min(result.created, count);
+            if (done < count && result.permanent && count > 1)
+                // l'une des questions restantes est refusée : elles sont retransmises une à une.
+                mIsolated = count - done;
+            else
+            {
+                if (done < count && result.permanent)
+                {
+                    reject(batch.front());
+                    done = 1;
+                }
+                if (mIsolated > 0 && done == 1)
+                    mIsolated--;
+            }
+            complete(done);
+            if (done < count && !result.permanent)
+            {
+                // nouvel essai après 1s, 2s, 4s ... jusqu'à 5 minutes.
+                backoff = std::min(std::max(backoff * 2, std::chrono::seconds(1)), std::chrono::seconds(300));
+                std::cout << mPending.size() << " questions en attente, nouvel essai dans " << backoff.count() << "s"
+                          << std::endl;
+                continue;
+            }
+            backoff = std::chrono::seconds(0);
+        }
+    }
+    /*
+     * Retrait des premières questions en attente, transmises ou écartées (appelée verrou pris).
+     * @param count : nombre de questions retirées.
+     */
+    void complete(std::size_t count)
+    {
+        if (count == 0)
+            return;
+        std::vector<uint64_t> ids;
+        for (std::size_t i = 0; i < count; i++)
+            ids.push_back(mPending[i].id);
+        mPending.erase(mPending.begin(), mPending.begin() + count);
+        // plus rien en attente : le journal peut être vidé.
+        if (mPending.empty() && mFile >= 0 && ::ftruncate(mFile, 0) == 0)
+            return;
+        for (auto id : ids)
+            append(json{{"done", id}});
+    }
+    /*
+     * Mise à l'écart d'une question refusée par le stockage, conservée pour être traitée à la main (appelée verrou
+     * pris).
+     */
+    void reject(const Entry &entry)
+    {
+        std::cout << "question refusée par le stockage, écartée dans " << mPath << ".rejected : "
+                  << entry.question.question << std::endl;
+        std::ofstream rejected(mPath + ".rejected", std::ios::app);
+        rejected << json{{"question", entry.question.question}, {"numQuestion", entry.question.numQuestion}}.dump()
+                 << std::endl;
+    }
+
+    IDataAccess &mDataAccess;
+    std::string mPath;
+    std::size_t mMaxBatch;
+    int mFile{-1};
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    // questions enregistrées dans le journal et pas encore transmises, dans l'ordre d'arrivée.
+    std::deque<Entry> mPending;
+    uint64_t mNextId{1};
+    // nombre de questions en tête de file à transmettre une à une (reste d'un lot refusé).
+    std::size_t mIsolated{0};
+    bool mStop{false};
+    std::thread mWriterThread;
+};
+#endif
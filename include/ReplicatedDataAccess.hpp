@@ -0,0 +1,111 @@
+#ifndef FAQ_REPLICATEDDATAACCESS_HPP
+#define FAQ_REPLICATEDDATAACCESS_HPP
+#include "FAQRow.hpp"
+#include "IDataAccess.hpp"
+#include "SqliteDataAccess.hpp"
+#include <iostream>
+#include <optional>
+#include <vector>
+/*
+ * Couche de données répliquée : la source (google sheets) reste la référence et reçoit toutes les écritures, son
+ * contenu est recopié dans une base SQLite locale à chaque synchronisation réussie et les lectures sont servies par
+ * cette copie. La FAQ reste ainsi disponible, dans son dernier état connu, au démarrage comme pendant une panne de
+ * la source.
+ */
+class ReplicatedDataAccess : public IDataAccess
+{
+  public:
+    /*
+     * Constructeur.
+     * @param pSource : couche de données de référence.
+     * @param pReplica : copie locale.
+     */
+    ReplicatedDataAccess(IDataAccess &pSource, SqliteDataAccess &pReplica) : mSource(pSource), mReplica(pReplica)
+    {
+    }
+
+    virtual bool createQuestion(const std::string &question, unsigned int numQuestion = 0)
+    {
+        return mSource.createQuestion(question, numQuestion);
+    }
+    virtual CreatedQuestions createQuestions(const std::vector<NewQuestion> &questions)
+    {
+        return mSource.createQuestions(questions);
+    }
+    virtual bool updateQuestion(int rowid, const std::string &reponse, bool reponse_valide)
+    {
+        return mSource.updateQuestion(rowid, reponse, reponse_valide);
+    }
+    virtual bool deleteQuestion(int rowid)
+    {
+        return mSource.deleteQuestion(rowid);
+    }
+    /*
+     * Synchronise la copie locale avec la source puis lit les Q/R validées dans la copie locale.
+     * @return null si la synchronisation a échoué : le cache conserve alors sa version et ne retient pas le jeton de
+     * changement, la lecture suivante retentera la synchronisation.
+     */
+    virtual std::optional<std::vector<FAQRow>> getAllValidated()
+    {
+        if (!sync())
+            return std::nullopt;
+        return mReplica.getAllValidated();
+    }
+    /*
+     * Lecture dans la copie locale, sans synchronisation.
+     */
+    virtual std::optional<std::vector<FAQRow>> getAll()
+    {
+        return mReplica.getAll();
+    }
+    virtual std::optional<std::vector<FAQRow>> getValidatedPage(std::size_t offset, std::size_t limit)
+    {
+        return mReplica.getValidatedPage(offset, limit);
+    }
+    virtual std::optional<std::string> getChangeToken()
+    {
+        return mSource.getChangeToken();
+    }
+    /*
+     * Recherche dans la copie locale.
+     */
+    virtual std::optional<std::vector<FAQRow>> search(const std::string &query, std::size_t limit)
+    {
+        return mReplica.search(query, limit);
+    }
+    /*
+     * Recopie de toutes les Q/R de la source dans la copie locale.
+     * @return vrai si la copie locale est à jour.
+     */
+    bool sync()
+    {
+        std::optional<std::vector<FAQRow>> rows;
+        try
+        {
+            rows = mSource.getAll();
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "lecture de la source impossible : " << e.what() << std::endl;
+        }
+        if (!rows.has_value())
+        {
+            std::cout << "source inaccessible, la copie locale n'est pas synchronisée" << std::endl;
+            return false;
+        }
+        // inutile de réécrire la base si rien n'a changé depuis la dernière synchronisation.
+        if (rows == mLastSync)
+            return true;
+        if (!mReplica.replaceAll(rows.value()))
+            return false;
+        mLastSync = std::move(rows);
+        return true;
+    }
+
+  private:
+    IDataAccess &mSource;
+    SqliteDataAccess &mReplica;
+    // dernier contenu recopié (utilisé uniquement par le thread de rafraîchissement du cache).
+    std::optional<std::vector<FAQRow>> mLastSync;
+};
+#endif
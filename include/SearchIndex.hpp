@@ -0,0 +1,249 @@
+#ifndef FAQ_SEARCHINDEX_HPP
+#define FAQ_SEARCHINDEX_HPP
+#include "CachedDataAccess.hpp"
+#include "FAQRow.hpp"
+#include "Tokenizer.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+/*
+ * Index inversé des Q/R validées pour la recherche plein texte.
+ * L'index est construit à partir de la photographie du cache (aucun appel à la couche de données) et mis à jour
+ * de façon incrémentale : lors d'un changement de version seules les Q/R ajoutées, modifiées ou supprimées sont
+ * réindexées. Les résultats sont classés par score BM25.
+ * Un dictionnaire trié des termes des questions sert en plus aux suggestions lors de la saisie (recherche par
+ * préfixe).
+ */
+class SearchIndex
+{
+  public:
+    /*
+     * Met l'index à jour à partir d'une photographie, ne fait rien si sa version est déjà indexée.
+     * @param snapshot : photographie des Q/R validées.
+     */
+    void sync(const FAQSnapshot &snapshot)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(mMutex);
+            if (snapshot.version == mVersion)
+                return;
+        }
+        std::unique_lock<std::shared_mutex> lock(mMutex);
+        // un autre thread a pu faire la mise à jour pendant l'attente du verrou.
+        if (snapshot.version == mVersion)
+            return;
+
+        std::map<unsigned int, const FAQRow *> current;
+        for (const auto &row : snapshot.rows)
+            current[row.ROWID] = &row;
+
+        // suppression des Q/R disparues ou modifiées.
+        for (auto it = mDocuments.begin(); it != mDocuments.end();)
+        {
+            auto found = current.find(it->first);
+            if (found == current.end() || *found->second != it->second.row)
+            {
+                removeDocument(it->first, it->second);
+                it = mDocuments.erase(it);
+            }
+            else
+                ++it;
+        }
+        // ajout des Q/R nouvelles ou modifiées.
+        for (const auto &[rowid, row] : current)
+            if (!mDocuments.contains(rowid))
+                addDocument(*row);
+
+        buildDictionary();
+        mVersion = snapshot.version;
+    }
+    /*
+     * Recherche des Q/R correspondant à une requête.
+     * @param query : texte saisi par l'utilisateur.
+     * @param limit : nombre maximum de résultats.
+     * @return les Q/R trouvées, de la plus pertinente à la moins pertinente.
+     */
+    std::vector<FAQRow> search(const std::string &query, std::size_t limit = 20) const
+    {
+        auto terms = Tokenizer::tokenize(query);
+        std::sort(terms.begin(), terms.end());
+        terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+        std::shared_lock<std::shared_mutex> lock(mMutex);
+        std::vector<FAQRow> retour;
+        if (terms.empty() || mDocuments.empty())
+            return retour;
+
+        double documentCount = static_cast<double>(mDocuments.size());
+        double averageLength = static_cast<double>(mTotalLength) / documentCount;
+        std::unordered_map<unsigned int, double> scores;
+        for (const auto &term : terms)
+        {
+            auto postings = mPostings.find(term);
+            if (postings == mPostings.end())
+                continue;
+            double documentFrequency = static_cast<double>(postings->second.size());
+            double idf = std::log(1.0 + (documentCount - documentFrequency + 0.5) / (documentFrequency + 0.5));
+            for (const auto &[rowid, frequency] : postings->second)
+            {
+                double length = static_cast<double>(mDocuments.at(rowid).length);
+                double tf = static_cast<double>(frequency);
+                scores[rowid] += idf * tf * (K1 + 1) / (tf + K1 * (1 - B + B * length / averageLength));
+            }
+        }
+
+        std::vector<std::pair<double, unsigned int>> ranking;
+        ranking.reserve(scores.size());
+        for (const auto &[rowid, score] : scores)
+            ranking.emplace_back(score, rowid);
+        // à score égal, l'ordre de la FAQ est conservé.
+        auto byScore = [](const auto &a, const auto &b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        };
+        std::size_t count = std::min(limit, ranking.size());
+        std::partial_sort(ranking.begin(), ranking.begin() + count, ranking.end(), byScore);
+
+        retour.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+            retour.push_back(mDocuments.at(ranking[i].second).row);
+        return retour;
+    }
+
+    /*
+     * Suggestions de questions pendant la saisie : tous les termes saisis doivent être présents dans la question, le
+     * dernier pouvant être incomplet (préfixe).
+     * @param input : texte en cours de saisie.
+     * @param limit : nombre maximum de suggestions.
+     * @return les Q/R dont la question correspond, dans l'ordre de la FAQ.
+     */
+    std::vector<FAQRow> suggest(const std::string &input, std::size_t limit = 8) const
+    {
+        // les mots vides sont conservés : "comm" doit pouvoir suggérer les questions commençant par "comment".
+        auto terms = Tokenizer::tokenize(input, true);
+        std::vector<FAQRow> retour;
+        // la saisie se termine par un séparateur : le dernier terme est complet.
+        bool lastIsPrefix = !input.empty() && !std::isspace(static_cast<unsigned char>(input.back()));
+
+        std::shared_lock<std::shared_mutex> lock(mMutex);
+        if (terms.empty())
+            return retour;
+
+        // ROWID des questions contenant chaque terme, triés pour l'intersection.
+        std::vector<unsigned int> candidates;
+        for (std::size_t i = 0; i < terms.size(); i++)
+        {
+            auto first = std::lower_bound(
+                mDictionary.begin(), mDictionary.end(), terms[i],
+                [](const auto &entry, const std::string &term) { return entry.first < term; });
+            std::vector<unsigned int> matching;
+            for (auto it = first; it != mDictionary.end(); ++it)
+            {
+                bool matches = i + 1 == terms.size() && lastIsPrefix ? it->first.starts_with(terms[i])
+                                                                     : it->first == terms[i];
+                if (!matches)
+                    break;
+                matching.insert(matching.end(), it->second.begin(), it->second.end());
+            }
+            std::sort(matching.begin(), matching.end());
+            matching.erase(std::unique(matching.begin(), matching.end()), matching.end());
+
+            if (i == 0)
+                candidates = std::move(matching);
+            else
+            {
+                std::vector<unsigned int> intersection;
+                std::set_intersection(candidates.begin(), candidates.end(), matching.begin(), matching.end(),
+                                      std::back_inserter(intersection));
+                candidates = std::move(intersection);
+            }
+            if (candidates.empty())
+                return retour;
+        }
+
+        retour.reserve(std::min(limit, candidates.size()));
+        for (std::size_t i = 0; i < candidates.size() && i < limit; i++)
+            retour.push_back(mDocuments.at(candidates[i]).row);
+        return retour;
+    }
+
+  private:
+    // paramètres usuels de BM25 : saturation de la fréquence d'un terme et normalisation par la longueur.
+    static constexpr double K1 = 1.2;
+    static constexpr double B = 0.75;
+
+    struct Document
+    {
+        FAQRow row;
+        // nombre de termes (la question comptant double).
+        std::size_t length{0};
+        std::unordered_map<std::string, unsigned int> frequencies;
+        // termes distincts de la question, mots vides compris (suggestions).
+        std::vector<std::string> questionTerms;
+    };
+    /*
+     * Indexation d'une Q/R, les termes de la question ont un poids double de ceux de la réponse.
+     */
+    void addDocument(const FAQRow &row)
+    {
+        Document document{row, 0, {}, Tokenizer::tokenize(row.QUESTION, true)};
+        for (const auto &term : document.questionTerms)
+            if (!Tokenizer::isStopWord(term))
+                document.frequencies[term] += 2;
+        std::sort(document.questionTerms.begin(), document.questionTerms.end());
+        document.questionTerms.erase(std::unique(document.questionTerms.begin(), document.questionTerms.end()),
+                                     document.questionTerms.end());
+        for (const auto &term : Tokenizer::tokenize(row.REPONSE))
+            document.frequencies[term]++;
+        for (const auto &[term, frequency] : document.frequencies)
+        {
+            mPostings[term][row.ROWID] = frequency;
+            document.length += frequency;
+        }
+        mTotalLength += document.length;
+        mDocuments.emplace(row.ROWID, std::move(document));
+    }
+    /*
+     * Retrait des termes d'une Q/R de l'index (le document lui-même est retiré par l'appelant).
+     */
+    void removeDocument(unsigned int rowid, const Document &document)
+    {
+        for (const auto &[term, frequency] : document.frequencies)
+        {
+            auto postings = mPostings.find(term);
+            postings->second.erase(rowid);
+            if (postings->second.empty())
+                mPostings.erase(postings);
+        }
+        mTotalLength -= document.length;
+    }
+    /*
+     * Reconstruction du dictionnaire trié des termes des questions.
+     */
+    void buildDictionary()
+    {
+        std::map<std::string, std::vector<unsigned int>> dictionary;
+        for (const auto &[rowid, document] : mDocuments)
+            for (const auto &term : document.questionTerms)
+                dictionary[term].push_back(rowid);
+        mDictionary.assign(std::make_move_iterator(dictionary.begin()), std::make_move_iterator(dictionary.end()));
+    }
+
+    mutable std::shared_mutex mMutex;
+    // version de la photographie indexée.
+    uint64_t mVersion{0};
+    // Q/R indexées par ROWID.
+    std::unordered_map<unsigned int, Document> mDocuments;
+    // terme -> (ROWID -> fréquence du terme dans la Q/R).
+    std::unordered_map<std::string, std::unordered_map<unsigned int, unsigned int>> mPostings;
+    std::size_t mTotalLength{0};
+    // dictionnaire des termes des questions trié par ordre alphabétique : les termes d'un même préfixe sont contigus.
+    std::vector<std::pair<std::string, std::vector<unsigned int>>> mDictionary;
+};
+#endif
@@ -1,7 +1,9 @@
 #ifndef FAQ_SECURITYMANAGER_HPP
 #define FAQ_SECURITYMANAGER_HPP
+#include "HttpClientPool.hpp"
 #include "Tools.hpp"
 #include "json/json.hpp"
+#include <iostream>
 #include <map>
 #include <optional>
 #include <string>
@@ -29,18 +31,30 @@ class SecurityManager
           mIpNextTryTime(pIpNextTryTime), mShowAskQuestion(pShowAskQuestion), mIpProtection(pIpProtection)
     {
     }
+    /*
+     * Vérification du captcha auprès de google.
+     * @param gToken : réponse du captcha fournie par le visiteur.
+     * @return vrai si le captcha est valide, faux s'il est invalide ou si google n'a pas pu le vérifier.
+     */
     bool validateCaptcha(const std::string &gToken)
     {
         // https://www.google.com/recaptcha/api/siteverify
         // secret
         // response
-        auto res = mHttpClient.Post("/recaptcha/api/siteverify?secret=" + mCaptchaSecret + "&response=" + gToken);
-
+        auto res = mHttpClients.send([&](httplib::Client &client) {
+            return client.Post("/recaptcha/api/siteverify?secret=" + mCaptchaSecret + "&response=" + gToken);
+        });
+        // aucune réponse (délai dépassé, disjoncteur ouvert ...) : le captcha est refusé.
+        if (!res)
+        {
+            std::cout << "vérification du captcha impossible : " << httplib::to_string(res.error()) << std::endl;
+            return false;
+        }
         if (res->status == 200)
         {
-            json bodyResponse = json::parse(res->body);
+            json bodyResponse = json::parse(res->body, nullptr, false);
 
-            return bodyResponse["success"];
+            return !bodyResponse.is_discarded() && bodyResponse.value("success", false);
         }
         return false;
     }
@@ -137,8 +151,8 @@ class SecurityManager
     }
 
   private:
-    // client http pour vérification captcha
-    httplib::Client mHttpClient{"https://www.google.com"};
+    // clients http pour vérification captcha
+    HttpClientPool mHttpClients{"https://www.google.com", 8, std::chrono::seconds(5), std::chrono::seconds(10)};
     // identifiant d'admin
     const std::string mLogin;
     // mot de passe admin.
@@ -0,0 +1,214 @@
+#ifndef FAQ_SHEETROWSPARSER_HPP
+#define FAQ_SHEETROWSPARSER_HPP
+#include "FAQRow.hpp"
+#include "json/json.hpp"
+#include <charconv>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+/*
+ * Lecture en flux (interface SAX de nlohmann::json) de la réponse de l'API sheets values:batchGet.
+ * Les cellules de valueRanges[0].values sont écrites directement dans des FAQRow au fil de la lecture : aucun arbre
+ * json n'est construit, les chaînes sont déplacées et non copiées, seules les 4 premières colonnes (numéro, question,
+ * réponse, statut) sont conservées.
+ * Une ligne dont le numéro n'est pas un entier est ignorée, une cellule absente (l'API omet les cellules vides de fin
+ * de ligne) est considérée vide.
+ */
+class SheetRowsParser : public nlohmann::json_sax<nlohmann::json>
+{
+  public:
+    /*
+     * Lecture des Q/R d'une réponse batchGet.
+     * @param body : corps de la réponse.
+     * @param onlyValidated : ne conserve que les Q/R dont la réponse est validée.
+     * @param maxRows : nombre maximum de Q/R conservées, les suivantes sont ignorées.
+     * @param skipHeader : la première ligne est l'intitulé des colonnes (faux pour une plage hors début de feuille).
+     * @return les Q/R dans l'ordre de la feuille (hors ligne d'entête), null si le json est invalide ou ne contient
+     * pas de valueRanges (réponse d'erreur de l'API).
+     */
+    static std::optional<std::vector<FAQRow>> parse(const std::string &body, bool onlyValidated = false,
+                                                     std::size_t maxRows = 100000, bool skipHeader = true)
+    {
+        SheetRowsParser parser(onlyValidated, maxRows, skipHeader);
+        if (!nlohmann::json::sax_parse(body, &parser))
+        {
+            std::cout << "réponse google sheets invalide : " << parser.mError << std::endl;
+            return std::nullopt;
+        }
+        if (!parser.mSawRanges)
+        {
+            std::cout << "réponse google sheets sans valueRanges : " << body.substr(0, 200) << std::endl;
+            return std::nullopt;
+        }
+        if (parser.mDroppedRows > 0)
+            std::cout << parser.mDroppedRows << " lignes ignorées au delà de " << maxRows << std::endl;
+        return {std::move(parser.mRows)};
+    }
+
+    bool null() override
+    {
+        return cell(std::string());
+    }
+    bool boolean(bool val) override
+    {
+        return cell(val ? "TRUE" : "FALSE");
+    }
+    bool number_integer(number_integer_t val) override
+    {
+        return cell(std::to_string(val));
+    }
+    bool number_unsigned(number_unsigned_t val) override
+    {
+        return cell(std::to_string(val));
+    }
+    bool number_float(number_float_t, const string_t &s) override
+    {
+        return cell(s);
+    }
+    bool string(string_t &val) override
+    {
+        return cell(std::move(val));
+    }
+    bool binary(binary_t &) override
+    {
+        return true;
+    }
+    bool start_object(std::size_t) override
+    {
+        mDepth++;
+        if (mDepth == 3)
+            mRangeKey.clear();
+        return true;
+    }
+    bool key(string_t &val) override
+    {
+        if (mDepth == 1)
+            mRootKey = val;
+        else if (mDepth == 3)
+            mRangeKey = val;
+        return true;
+    }
+    bool end_object() override
+    {
+        if (mDepth == 3 && mInRanges)
+            mRangeIndex++;
+        mDepth--;
+        return true;
+    }
+    bool start_array(std::size_t) override
+    {
+        mDepth++;
+        if (mDepth == 2 && mRootKey == "valueRanges")
+            mInRanges = mSawRanges = true;
+        else if (mDepth == 4 && mInRanges && mRangeIndex == 0 && mRangeKey == "values")
+            mInValues = true;
+        else if (mDepth == 5 && mInValues)
+        {
+            mInRow = true;
+            mCellIndex = 0;
+            mRowValid = true;
+            mCurrent = FAQRow{0, "", "", "", "", false};
+        }
+        return true;
+    }
+    bool end_array() override
+    {
+        if (mDepth == 5 && mInRow)
+        {
+            endRow();
+            mInRow = false;
+        }
+        else if (mDepth == 4)
+            mInValues = false;
+        else if (mDepth == 2)
+            mInRanges = false;
+        mDepth--;
+        return true;
+    }
+    bool parse_error(std::size_t position, const std::string &, const nlohmann::detail::exception &ex) override
+    {
+        mError = std::to_string(position) + " : " + ex.what();
+        return false;
+    }
+
+  private:
+    SheetRowsParser(bool pOnlyValidated, std::size_t pMaxRows, bool pSkipHeader)
+        : mOnlyValidated(pOnlyValidated), mMaxRows(pMaxRows), mSkipHeader(pSkipHeader)
+    {
+    }
+    /*
+     * @return vrai si la ligne courante contient l'intitulé des colonnes.
+     */
+    bool isHeader() const
+    {
+        return mSkipHeader && mRowIndex == 0;
+    }
+    /*
+     * Valeur d'une cellule : seules les cellules directement dans une ligne de valueRanges[0].values sont lues.
+     */
+    bool cell(std::string value)
+    {
+        if (!mInRow || mDepth != 5)
+            return true;
+        switch (mCellIndex++)
+        {
+            case 0: {
+                // numéro de la question, la ligne est ignorée s'il n'est pas numérique (entête, ligne vide ...).
+                auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), mCurrent.ROWID);
+                mRowValid = error == std::errc() && end != value.data();
+                if (!mRowValid && !isHeader())
+                    std::cout << "impossible d'instancier objet FAQRow : " << value << "\n";
+                break;
+            }
+            case 1:
+                mCurrent.QUESTION = std::move(value);
+                break;
+            case 2:
+                mCurrent.REPONSE = std::move(value);
+                break;
+            case 3:
+                mCurrent.REPONSE_VALIDE = value == "Validé";
+                break;
+            default:
+                break;
+        }
+        return true;
+    }
+    /*
+     * Fin d'une ligne : la Q/R est conservée si elle est valide (hors entête).
+     */
+    void endRow()
+    {
+        // la première ligne contient l'intitulé des colonnes.
+        bool header = isHeader();
+        mRowIndex++;
+        if (header || !mRowValid || (mOnlyValidated && !mCurrent.REPONSE_VALIDE))
+            return;
+        if (mRows.size() >= mMaxRows)
+            mDroppedRows++;
+        else
+            mRows.push_back(std::move(mCurrent));
+    }
+
+    bool mOnlyValidated;
+    std::size_t mMaxRows;
+    bool mSkipHeader;
+    // profondeur courante (1 = objet racine, 2 = valueRanges, 3 = une plage, 4 = values, 5 = une ligne).
+    int mDepth{0};
+    std::string mRootKey;
+    std::string mRangeKey;
+    bool mSawRanges{false};
+    bool mInRanges{false};
+    std::size_t mRangeIndex{0};
+    bool mInValues{false};
+    bool mInRow{false};
+    std::size_t mRowIndex{0};
+    std::size_t mCellIndex{0};
+    bool mRowValid{false};
+    FAQRow mCurrent;
+    std::vector<FAQRow> mRows;
+    std::size_t mDroppedRows{0};
+    std::string mError;
+};
+#endif
@@ -0,0 +1,58 @@
+#ifndef FAQ_SINGLEFLIGHT_HPP
+#define FAQ_SINGLEFLIGHT_HPP
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+/*
+ * Regroupement des appels simultanés identiques.
+ * Le premier thread qui demande une clé exécute l'appel, les threads qui demandent la même clé pendant son exécution
+ * attendent son résultat (ou son exception) au lieu de refaire l'appel. Une demande arrivant après la fin de l'appel
+ * en déclenche un nouveau : rien n'est mis en cache.
+ */
+template <typename Key, typename Value> class SingleFlight
+{
+  public:
+    /*
+     * Exécution (ou attente) de l'appel associé à une clé.
+     * @param key : clé identifiant l'appel.
+     * @param call : appel à exécuter si aucun appel n'est en cours pour cette clé.
+     * @return le résultat de l'appel, partagé par tous les threads qui l'ont attendu.
+     */
+    Value run(const Key &key, const std::function<Value()> &call)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        auto found = mCalls.find(key);
+        if (found != mCalls.end())
+        {
+            // appel déjà en cours : on attend son résultat, hors verrou.
+            auto pending = found->second;
+            lock.unlock();
+            return pending.get();
+        }
+        std::promise<Value> promise;
+        auto pending = promise.get_future().share();
+        mCalls.emplace(key, pending);
+        lock.unlock();
+
+        try
+        {
+            promise.set_value(call());
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+        }
+        lock.lock();
+        mCalls.erase(key);
+        lock.unlock();
+        return pending.get();
+    }
+
+  private:
+    std::mutex mMutex;
+    // appels en cours.
+    std::map<Key, std::shared_future<Value>> mCalls;
+};
+#endif
@@ -0,0 +1,193 @@
+#ifndef FAQ_SNAPSHOTFILE_HPP
+#define FAQ_SNAPSHOTFILE_HPP
+#include "FAQRow.hpp"
+#include "FAQSnapshot.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+/*
+ * Sauvegarde d'une photographie des Q/R dans un fichier binaire compact, relu d'un bloc au démarrage.
+ * Format (entiers little-endian de la machine) :
+ * - entête : "FAQSNAP1", nombre de Q/R, version, moment de dernière modification, taille de la table des chaînes ;
+ * - une fiche de taille fixe par Q/R : ROWID, réponse validée, puis position et longueur de chacune des 4 chaînes ;
+ * - la table des chaînes : toutes les chaînes mises bout à bout.
+ * Le fichier est écrit à côté puis renommé, il est donc toujours complet.
+ */
+class SnapshotFile
+{
+  public:
+    /*
+     * Écriture de la photographie.
+     * @param path : chemin du fichier.
+     * @param snapshot : photographie à sauvegarder.
+     * @return vrai si le fichier a été écrit, faux sinon.
+     */
+    static bool write(const std::string &path, const FAQSnapshot &snapshot)
+    {
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.rowCount = snapshot.rows.size();
+        header.version = snapshot.version;
+        header.lastModified = snapshot.lastModified;
+
+        std::vector<Record> records;
+        records.reserve(snapshot.rows.size());
+        std::string strings;
+        auto addString = [&strings](const std::string &value, uint32_t &offset, uint32_t &length) {
+            offset = strings.size();
+            length = value.size();
+            strings += value;
+        };
+        for (const auto &row : snapshot.rows)
+        {
+            Record record{};
+            record.rowid = row.ROWID;
+            record.validated = row.REPONSE_VALIDE ? 1 : 0;
+            addString(row.QUESTION, record.strings[0].offset, record.strings[0].length);
+            addString(row.REPONSE, record.strings[1].offset, record.strings[1].length);
+            addString(row.DATE_AJOUT_QUESTION, record.strings[2].offset, record.strings[2].length);
+            addString(row.DATE_AJOUT_REPONSE, record.strings[3].offset, record.strings[3].length);
+            records.push_back(record);
+        }
+        header.stringsSize = strings.size();
+
+        std::string temporary = path + ".tmp";
+        int file = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+        if (file < 0)
+        {
+            std::cout << "écriture de la photographie impossible : " << temporary << std::endl;
+            return false;
+        }
+        bool written = writeAll(file, &header, sizeof(header)) &&
+                       writeAll(file, records.data(), records.size() * sizeof(Record)) &&
+                       writeAll(file, strings.data(), strings.size()) && ::fsync(file) == 0;
+        ::close(file);
+        // le renommage remplace l'ancien fichier en une seule opération.
+        if (!written || std::rename(temporary.c_str(), path.c_str()) != 0)
+        {
+            std::cout << "écriture de la photographie impossible : " << path << std::endl;
+            std::remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+    /*
+     * Lecture de la photographie.
+     * @param path : chemin du fichier.
+     * @return la photographie, ou null si le fichier est absent ou invalide.
+     */
+    static std::optional<FAQSnapshot> read(const std::string &path)
+    {
+        int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+            return std::nullopt;
+        struct stat status;
+        if (::fstat(file, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(Header))
+        {
+            ::close(file);
+            return std::nullopt;
+        }
+        // chaque chaîne est de toute façon copiée dans sa FAQRow : le fichier est lu en une fois dans un tampon.
+        std::string data(status.st_size, '\0');
+        bool complete = readAll(file, data.data(), data.size());
+        ::close(file);
+        if (!complete)
+            return std::nullopt;
+
+        auto retour = parse(data);
+        if (!retour.has_value())
+            std::cout << "photographie invalide ignorée : " << path << std::endl;
+        return retour;
+    }
+
+  private:
+    static constexpr char MAGIC[8] = {'F', 'A', 'Q', 'S', 'N', 'A', 'P', '1'};
+
+    struct Header
+    {
+        char magic[8];
+        uint64_t rowCount;
+        uint64_t version;
+        int64_t lastModified;
+        uint64_t stringsSize;
+    };
+    struct StringRef
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+    struct Record
+    {
+        uint32_t rowid;
+        uint32_t validated;
+        // question, réponse, date d'ajout de la question, date d'ajout de la réponse.
+        StringRef strings[4];
+    };
+    /*
+     * Décodage du contenu du fichier, chaque position est vérifiée avant d'être lue.
+     */
+    static std::optional<FAQSnapshot> parse(std::string_view data)
+    {
+        Header header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header.rowCount > (data.size() - sizeof(Header)) / sizeof(Record) ||
+            sizeof(Header) + header.rowCount * sizeof(Record) + header.stringsSize != data.size())
+            return std::nullopt;
+
+        const char *recordsStart = data.data() + sizeof(Header);
+        std::string_view strings = data.substr(sizeof(Header) + header.rowCount * sizeof(Record));
+        FAQSnapshot snapshot;
+        snapshot.version = header.version;
+        snapshot.lastModified = header.lastModified;
+        snapshot.rows.reserve(header.rowCount);
+        for (std::size_t i = 0; i < header.rowCount; i++)
+        {
+            Record record;
+            std::memcpy(&record, recordsStart + i * sizeof(Record), sizeof(Record));
+            for (const auto &ref : record.strings)
+                if (static_cast<uint64_t>(ref.offset) + ref.length > strings.size())
+                    return std::nullopt;
+            auto text = [&strings](const StringRef &ref) {
+                return std::string(strings.substr(ref.offset, ref.length));
+            };
+            snapshot.rows.push_back(FAQRow{record.rowid, text(record.strings[0]), text(record.strings[1]),
+                                           text(record.strings[2]), text(record.strings[3]), record.validated != 0});
+        }
+        return snapshot;
+    }
+    static bool readAll(int file, char *data, std::size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t count = ::read(file, data, size);
+            if (count <= 0)
+                return false;
+            data += count;
+            size -= count;
+        }
+        return true;
+    }
+    static bool writeAll(int file, const void *data, std::size_t size)
+    {
+        const char *current = static_cast<const char *>(data);
+        while (size > 0)
+        {
+            ssize_t count = ::write(file, current, size);
+            if (count <= 0)
+                return false;
+            current += count;
+            size -= count;
+        }
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,256 @@
+#ifndef FAQ_SQLITECONNECTIONPOOL_HPP
+#define FAQ_SQLITECONNECTIONPOOL_HPP
+#include "SQLiteCpp/SQLiteCpp.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+/*
+ * Réglages SQLite appliqués à chaque connexion, les valeurs vides ou nulles conservent le réglage par défaut.
+ */
+struct SqliteOptions
+{
+    // mode de journalisation (WAL conseillé : les lectures ne sont jamais bloquées par une écriture).
+    std::string journalMode;
+    // niveau de synchronisation sur disque (NORMAL suffit en mode WAL).
+    std::string synchronous;
+    // taille du cache en pages, ou en Kio si négative.
+    int cacheSize{0};
+    // taille maximum (en octets) de la base lue par mmap.
+    int64_t mmapSize{0};
+};
+/*
+ * Connexions persistantes à une base SQLite.
+ * Chaque thread lecteur dispose de sa propre connexion en lecture seule, ouverte à sa première lecture et conservée
+ * ensuite : aucune connexion n'est partagée entre threads, les lectures ne prennent donc aucun verrou applicatif.
+ * Les écritures sont toutes exécutées par un unique thread d'écriture, avec sa propre connexion : les écritures
+ * demandées pendant la validation précédente sont regroupées dans une seule transaction (une seule synchronisation
+ * sur disque pour tout le lot), chacune dans un savepoint pour qu'un échec n'annule qu'elle-même.
+ * Chaque connexion garde ses requêtes préparées : une requête n'est compilée qu'une fois par connexion.
+ */
+class SqliteConnectionPool
+{
+  public:
+    /*
+     * Connexion et ses requêtes préparées, utilisée par un seul thread à la fois.
+     */
+    class Connection
+    {
+      public:
+        Connection(const std::string &pPath, int pFlags, const SqliteOptions &pOptions)
+            : mDatabase(pPath, pFlags, BUSY_TIMEOUT_MS)
+        {
+            // le mode de journalisation est enregistré dans la base, seule la connexion d'écriture le modifie.
+            if (!pOptions.journalMode.empty() && (pFlags & SQLite::OPEN_READWRITE) != 0)
+                mDatabase.exec("PRAGMA journal_mode=" + pOptions.journalMode);
+            if (!pOptions.synchronous.empty())
+                mDatabase.exec("PRAGMA synchronous=" + pOptions.synchronous);
+            if (pOptions.cacheSize != 0)
+                mDatabase.exec("PRAGMA cache_size=" + std::to_string(pOptions.cacheSize));
+            if (pOptions.mmapSize > 0)
+                mDatabase.exec("PRAGMA mmap_size=" + std::to_string(pOptions.mmapSize));
+        }
+        /*
+         * Requête préparée prête à être exécutée (réinitialisée, sans paramètres).
+         * @param sql : texte de la requête, qui sert de clé du cache.
+         * @return la requête, valable aussi longtemps que la connexion.
+         */
+        SQLite::Statement &prepare(const std::string &sql)
+        {
+            auto &statement = mStatements[sql];
+            if (!statement)
+                statement = std::make_unique<SQLite::Statement>(mDatabase, sql);
+            else
+            {
+                statement->reset();
+                statement->clearBindings();
+            }
+            return *statement;
+        }
+        SQLite::Database &database()
+        {
+            return mDatabase;
+        }
+
+      private:
+        SQLite::Database mDatabase;
+        std::unordered_map<std::string, std::unique_ptr<SQLite::Statement>> mStatements;
+    };
+    /*
+     * Constructeur, ouvre la connexion d'écriture (et crée la base si elle n'existe pas) puis démarre le thread
+     * d'écriture.
+     * @param pPath : chemin du fichier de base de données.
+     * @param pOptions : réglages SQLite.
+     */
+    SqliteConnectionPool(const std::string &pPath, const SqliteOptions &pOptions = {})
+        : mPath(pPath), mOptions(pOptions), mId(nextId()),
+          mWriter(pPath, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, pOptions)
+    {
+        mWriterThread = std::thread([this]() { run(); });
+    }
+    SqliteConnectionPool(const SqliteConnectionPool &) = delete;
+    SqliteConnectionPool &operator=(const SqliteConnectionPool &) = delete;
+
+    ~SqliteConnectionPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mWriterMutex);
+            mStop = true;
+        }
+        mWriterCondition.notify_all();
+        if (mWriterThread.joinable())
+            mWriterThread.join();
+    }
+    /*
+     * @return la connexion en lecture seule du thread appelant.
+     */
+    Connection &reader()
+    {
+        // connexions du thread, par pool : elles restent détenues par le pool et disparaissent avec lui.
+        thread_local std::unordered_map<uint64_t, std::weak_ptr<Connection>> connections;
+        auto &connection = connections[mId];
+        if (auto existing = connection.lock())
+            return *existing;
+        auto created = std::make_shared<Connection>(mPath, SQLite::OPEN_READONLY, mOptions);
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mReaders.push_back(created);
+        }
+        connection = created;
+        return *created;
+    }
+    /*
+     * Exécution d'une écriture par le thread d'écriture, bloquante jusqu'à la validation de la transaction.
+     * Le traitement ne doit pas ouvrir de transaction : il est déjà exécuté dans celle du lot.
+     * @param work : traitement recevant la connexion d'écriture.
+     * @return le résultat du traitement, son exception ou celle de la validation est relancée.
+     */
+    template <typename Work> auto write(Work &&work)
+    {
+        using Result = std::invoke_result_t<Work &, Connection &>;
+        std::promise<void> committed;
+        auto future = committed.get_future();
+        if constexpr (std::is_void_v<Result>)
+        {
+            enqueue({[&work](Connection &connection) { work(connection); }, &committed});
+            future.get();
+        }
+        else
+        {
+            std::optional<Result> result;
+            enqueue({[&work, &result](Connection &connection) { result.emplace(work(connection)); }, &committed});
+            future.get();
+            return std::move(result.value());
+        }
+    }
+
+  private:
+    /*
+     * Écriture en attente : traitement et promesse tenue après la validation du lot.
+     */
+    struct Job
+    {
+        std::function<void(Connection &)> work;
+        std::promise<void> *committed;
+    };
+    void enqueue(Job job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mWriterMutex);
+            mJobs.push_back(std::move(job));
+        }
+        mWriterCondition.notify_one();
+    }
+    /*
+     * Boucle du thread d'écriture : toutes les écritures en attente sont exécutées dans une seule transaction.
+     */
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mWriterMutex);
+        while (true)
+        {
+            mWriterCondition.wait(lock, [this]() { return mStop || !mJobs.empty(); });
+            // les écritures déjà demandées sont exécutées avant l'arrêt.
+            if (mJobs.empty())
+                return;
+            std::vector<Job> batch;
+            batch.swap(mJobs);
+            lock.unlock();
+
+            std::vector<std::exception_ptr> errors(batch.size());
+            try
+            {
+                SQLite::Transaction transaction(mWriter.database());
+                for (std::size_t i = 0; i < batch.size(); i++)
+                {
+                    mWriter.database().exec("SAVEPOINT job");
+                    try
+                    {
+                        batch[i].work(mWriter);
+                        mWriter.database().exec("RELEASE job");
+                    }
+                    catch (...)
+                    {
+                        errors[i] = std::current_exception();
+                        mWriter.database().exec("ROLLBACK TO job");
+                        mWriter.database().exec("RELEASE job");
+                    }
+                }
+                transaction.commit();
+            }
+            catch (const std::exception &e)
+            {
+                // validation impossible : aucune écriture du lot n'est enregistrée.
+                std::cout << "écriture de " << batch.size() << " requêtes SQLite impossible : " << e.what()
+                          << std::endl;
+                for (auto &error : errors)
+                    if (!error)
+                        error = std::current_exception();
+            }
+            for (std::size_t i = 0; i < batch.size(); i++)
+            {
+                if (errors[i])
+                    batch[i].committed->set_exception(errors[i]);
+                else
+                    batch[i].committed->set_value();
+            }
+            lock.lock();
+        }
+    }
+
+    // délai d'attente d'une connexion lorsque la base est verrouillée par une autre.
+    static constexpr int BUSY_TIMEOUT_MS = 5000;
+
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    std::string mPath;
+    SqliteOptions mOptions;
+    // identifiant unique du pool, clé des connexions de chaque thread.
+    uint64_t mId;
+    // connexion utilisée uniquement par le thread d'écriture.
+    Connection mWriter;
+    std::mutex mMutex;
+    std::vector<std::shared_ptr<Connection>> mReaders;
+    std::mutex mWriterMutex;
+    std::condition_variable mWriterCondition;
+    // écritures en attente, dans l'ordre des demandes.
+    std::vector<Job> mJobs;
+    bool mStop{false};
+    std::thread mWriterThread;
+};
+#endif
@@ -1,30 +1,58 @@
-#ifndef FAQ_DATAACCESS_HPP
-#define FAQ_DATAACCESS_HPP
+#ifndef FAQ_SQLITEDATAACCESS_HPP
+#define FAQ_SQLITEDATAACCESS_HPP
 #include "FAQRow.hpp"
 #include "IDataAccess.hpp"
 #include "SQLiteCpp/SQLiteCpp.h"
+#include "SqliteConnectionPool.hpp"
+#include "Tokenizer.hpp"
 #include <iostream>
 #include <optional>
+#include <sqlite3.h>
+#include <string>
+#include <utility>
 #include <vector>
+/*
+ * Classe d'accès aux données s'appuyant sur une base SQLite locale.
+ * Les connexions et les requêtes préparées sont conservées d'un appel à l'autre (SqliteConnectionPool).
+ * La recherche s'appuie sur un index plein texte FTS5 (table FAQ_FTS) des questions et réponses, tenu à jour par des
+ * triggers sur la table FAQ n'utilisant que des fonctions SQL intégrées : la table peut être modifiée par un autre
+ * programme (réponse ou validation saisie directement dans la base). Le html est indexé tel quel, le tokenizer
+ * unicode61 traitant < et > comme des séparateurs, les balises sont retirées des extraits au moment de la recherche.
+ * Les ligatures sont repliées dans le texte indexé comme dans les termes cherchés (œ devient oe), les extraits les
+ * montrent donc repliées.
+ */
 class SqliteDataAccess : public IDataAccess
 {
   public:
-    SqliteDataAccess(const std::string &database) : mDatabase(database)
+    /*
+     * Constructeur, crée la base si elle n'existe pas et met son schéma à jour.
+     * @param database : chemin du fichier de base de données.
+     * @param options : réglages SQLite (mode WAL, mmap ...).
+     */
+    SqliteDataAccess(const std::string &database, const SqliteOptions &options = {})
+        : mConnections(database, options)
     {
+        mConnections.write([](SqliteConnectionPool::Connection &connection) {
+            // utilisée uniquement par la migration 2.
+            connection.database().createFunction("faq_text", 1, true, nullptr, &SqliteDataAccess::sqlPlainText);
+            migrate(connection.database());
+        });
     }
-    bool createQuestion(const std::string &question)
+    /*
+     * Le numéro de question est ignoré, le ROWID est attribué par SQLite.
+     */
+    virtual bool createQuestion(const std::string &question, unsigned int = 0)
     {
         std::cout << "CREATE "
                   << " Question : " << question << std::endl;
         try
         {
-            // Open a database file
-            SQLite::Database db(mDatabase, SQLite::OPEN_READWRITE);
+            mConnections.write([&](SqliteConnectionPool::Connection &connection) {
+                SQLite::Statement &query = connection.prepare(INSERT_QUESTION);
 
-            SQLite::Statement query(db, "INSERT INTO FAQ VALUES (?,NULL,DATETIME(),NULL,0)");
-
-            query.bind(1, question);
-            query.exec();
+                query.bind(1, question);
+                query.exec();
+            });
             return true;
         }
         catch (std::exception &e)
@@ -33,21 +61,52 @@ class SqliteDataAccess : public IDataAccess
         }
         return false;
     }
-    bool updateQuestion(int rowid, const std::string &reponse, bool reponse_valide)
+    /*
+     * Création des questions dans une seule écriture : toutes sont créées ou aucune. Une contrainte non respectée ou
+     * une valeur refusée par SQLite est un échec définitif, toute autre erreur (base verrouillée, disque plein ...)
+     * est passagère.
+     */
+    virtual CreatedQuestions createQuestions(const std::vector<NewQuestion> &questions)
+    {
+        try
+        {
+            mConnections.write([&](SqliteConnectionPool::Connection &connection) {
+                SQLite::Statement &query = connection.prepare(INSERT_QUESTION);
+                for (const auto &newQuestion : questions)
+                {
+                    query.bind(1, newQuestion.question);
+                    query.exec();
+                    query.reset();
+                }
+            });
+            return {questions.size(), false};
+        }
+        catch (const SQLite::Exception &e)
+        {
+            std::cout << "exception: " << e.what() << std::endl;
+            int code = e.getErrorCode();
+            return {0, code == SQLITE_CONSTRAINT || code == SQLITE_TOOBIG || code == SQLITE_MISMATCH};
+        }
+        catch (std::exception &e)
+        {
+            std::cout << "exception: " << e.what() << std::endl;
+        }
+        return {};
+    }
+    virtual bool updateQuestion(int rowid, const std::string &reponse, bool reponse_valide)
     {
         std::cout << "UPDATE " << rowid << " Reponse : " << reponse << " valide : " << reponse_valide << std::endl;
         try
         {
-            // Open a database file
-            SQLite::Database db(mDatabase, SQLite::OPEN_READWRITE);
+            mConnections.write([&](SqliteConnectionPool::Connection &connection) {
+                SQLite::Statement &query = connection.prepare(
+                    "UPDATE FAQ SET REPONSE=?, REPONSE_VALIDE=?, DATE_AJOUT_REPONSE=datetime() WHERE ROWID=?");
 
-            SQLite::Statement query(
-                db, "UPDATE FAQ SET REPONSE=?, REPONSE_VALIDE=?, DATE_AJOUT_REPONSE=datetime() WHERE ROWID=?");
-
-            query.bind(1, reponse);
-            query.bind(2, reponse_valide ? 1 : 0);
-            query.bind(3, rowid);
-            query.exec();
+                query.bind(1, reponse);
+                query.bind(2, reponse_valide ? 1 : 0);
+                query.bind(3, rowid);
+                query.exec();
+            });
             return true;
         }
         catch (std::exception &e)
@@ -56,19 +115,18 @@ class SqliteDataAccess : public IDataAccess
         }
         return false;
     }
-    bool deleteQuestion(int rowid)
+    virtual bool deleteQuestion(int rowid)
     {
         std::cout << "DELETE" << std::endl;
         try
         {
-            // Open a database file
-            SQLite::Database db(mDatabase, SQLite::OPEN_READWRITE);
-
-            // Compile a SQL query, containing one parameter (index 1)
-            SQLite::Statement query(db, "DELETE FROM FAQ WHERE ROWID=(?)");
+            mConnections.write([&](SqliteConnectionPool::Connection &connection) {
+                // Compile a SQL query, containing one parameter (index 1)
+                SQLite::Statement &query = connection.prepare("DELETE FROM FAQ WHERE ROWID=(?)");
 
-            query.bind(1, rowid);
-            query.exec();
+                query.bind(1, rowid);
+                query.exec();
+            });
             return true;
         }
         catch (std::exception &e)
@@ -77,43 +135,229 @@ class SqliteDataAccess : public IDataAccess
         }
         return false;
     }
-    std::optional<std::vector<FAQRow>> getAllValidated()
+    /*
+     * Lecture par l'index partiel FAQ_VALIDE, dans l'ordre des ROWID.
+     */
+    virtual std::optional<std::vector<FAQRow>> getAllValidated()
+    {
+        return fetchAndMapResults(SELECT_VALIDATED);
+    }
+    virtual std::optional<std::vector<FAQRow>> getValidatedPage(std::size_t offset, std::size_t limit)
     {
-        return fetchAndMapResults("SELECT ROWID,QUESTION,REPONSE,DATE_AJOUT_QUESTION,DATE_AJOUT_REPONSE,REPONSE_VALIDE "
-                                  "FROM FAQ WHERE REPONSE_VALIDE = 1");
+        return fetchAndMapResults(SELECT_VALIDATED_PAGE, {static_cast<int64_t>(limit), static_cast<int64_t>(offset)});
     }
-    std::optional<std::vector<FAQRow>> getAll()
+    virtual std::optional<std::vector<FAQRow>> getAll()
     {
         return fetchAndMapResults(
             "SELECT ROWID,QUESTION,REPONSE,DATE_AJOUT_QUESTION,DATE_AJOUT_REPONSE,REPONSE_VALIDE FROM FAQ");
     }
+    /*
+     * Recherche dans l'index plein texte, classée par bm25 (les termes trouvés dans la question comptent double).
+     * La réponse retournée est un extrait d'une vingtaine de mots autour des termes trouvés, surlignés par <mark>.
+     * Les termes sont marqués par les caractères \x02 et \x03 dans l'extrait, remplacés par snippetHtml().
+     */
+    virtual std::optional<std::vector<FAQRow>> search(const std::string &query, std::size_t limit)
+    {
+        // chaque terme est cité pour que la saisie du visiteur ne soit pas interprétée comme une syntaxe FTS5, une Q/R
+        // contenant au moins l'un des termes est retenue.
+        std::string match;
+        for (const auto &term : Tokenizer::tokenize(query))
+            match += (match.empty() ? "\"" : " OR \"") + term + "\"";
+        if (match.empty())
+            return {std::vector<FAQRow>()};
+        try
+        {
+            SQLite::Statement &request = mConnections.reader().prepare(
+                "SELECT FAQ.ROWID,FAQ.QUESTION,snippet(FAQ_FTS, 1, char(2), char(3), '…', 24),"
+                "FAQ.DATE_AJOUT_QUESTION,FAQ.DATE_AJOUT_REPONSE,FAQ.REPONSE_VALIDE "
+                "FROM FAQ_FTS JOIN FAQ ON FAQ.ROWID = FAQ_FTS.rowid "
+                "WHERE FAQ_FTS MATCH ? AND FAQ.REPONSE_VALIDE = 1 ORDER BY bm25(FAQ_FTS, 2.0, 1.0) LIMIT ?");
+            request.bind(1, match);
+            request.bind(2, static_cast<int64_t>(limit));
+            std::vector<FAQRow> retourRequete;
+            while (request.executeStep())
+            {
+                retourRequete.push_back(mapRow(request));
+                retourRequete.back().REPONSE = snippetHtml(retourRequete.back().REPONSE);
+            }
+            request.reset();
+            return {retourRequete};
+        }
+        catch (std::exception &e)
+        {
+            std::cout << "exception: " << e.what() << std::endl;
+        }
+        return std::nullopt;
+    }
+
+    /*
+     * Remplacement de toutes les Q/R par celles fournies, en une seule écriture (la base reste dans son état
+     * précédent en cas d'erreur).
+     * @param rows : Q/R à enregistrer, le ROWID de chacune est conservé.
+     * @return vrai si les Q/R ont été enregistrées, faux sinon.
+     */
+    bool replaceAll(const std::vector<FAQRow> &rows)
+    {
+        try
+        {
+            mConnections.write([&](SqliteConnectionPool::Connection &connection) {
+                connection.database().exec("DELETE FROM FAQ");
+
+                // une ligne en double dans la feuille (même numéro) remplace la précédente.
+                SQLite::Statement &query =
+                    connection.prepare("INSERT OR REPLACE INTO FAQ (ROWID,QUESTION,REPONSE,DATE_AJOUT_QUESTION,"
+                                       "DATE_AJOUT_REPONSE,REPONSE_VALIDE) VALUES (?,?,?,?,?,?)");
+                for (const auto &row : rows)
+                {
+                    query.bind(1, static_cast<int64_t>(row.ROWID));
+                    query.bind(2, row.QUESTION);
+                    query.bind(3, row.REPONSE);
+                    query.bind(4, row.DATE_AJOUT_QUESTION);
+                    query.bind(5, row.DATE_AJOUT_REPONSE);
+                    query.bind(6, row.REPONSE_VALIDE ? 1 : 0);
+                    query.exec();
+                    query.reset();
+                }
+            });
+            return true;
+        }
+        catch (std::exception &e)
+        {
+            std::cout << "exception: " << e.what() << std::endl;
+        }
+        return false;
+    }
+
+    // lectures des Q/R validées, qui doivent passer par l'index FAQ_VALIDE (plan vérifié par les tests).
+    static constexpr const char *SELECT_VALIDATED =
+        "SELECT ROWID,QUESTION,REPONSE,DATE_AJOUT_QUESTION,DATE_AJOUT_REPONSE,REPONSE_VALIDE "
+        "FROM FAQ WHERE REPONSE_VALIDE = 1 ORDER BY ROWID";
+    static constexpr const char *SELECT_VALIDATED_PAGE =
+        "SELECT ROWID,QUESTION,REPONSE,DATE_AJOUT_QUESTION,DATE_AJOUT_REPONSE,REPONSE_VALIDE "
+        "FROM FAQ WHERE REPONSE_VALIDE = 1 ORDER BY ROWID LIMIT ? OFFSET ?";
 
   private:
-    std::optional<std::vector<FAQRow>> fetchAndMapResults(const std::string &request)
+    static constexpr const char *INSERT_QUESTION =
+        "INSERT INTO FAQ (QUESTION,DATE_AJOUT_QUESTION,REPONSE_VALIDE) VALUES (?,DATETIME(),0)";
+    /*
+     * Mise à jour du schéma : les étapes dont le numéro dépasse PRAGMA user_version sont appliquées dans l'ordre,
+     * puis user_version prend le numéro de la dernière (dans la transaction d'écriture, tout ou rien).
+     * Une étape n'est jamais modifiée une fois publiée : tout changement de schéma se fait par une nouvelle étape.
+     */
+    static void migrate(SQLite::Database &db)
     {
+        static const std::vector<std::vector<std::string>> steps = {
+            // 1 : table des Q/R (les bases antérieures aux migrations l'ont déjà).
+            {"CREATE TABLE IF NOT EXISTS FAQ (QUESTION TEXT, REPONSE TEXT, DATE_AJOUT_QUESTION TEXT, "
+             "DATE_AJOUT_REPONSE TEXT, REPONSE_VALIDE INTEGER DEFAULT 0)"},
+            // 2 : index plein texte, unicode61 remove_diacritics : "présenté" est trouvé en cherchant "presente".
+            {"CREATE VIRTUAL TABLE IF NOT EXISTS FAQ_FTS USING fts5(QUESTION, REPONSE, "
+             "tokenize='unicode61 remove_diacritics 2')",
+             "CREATE TRIGGER IF NOT EXISTS FAQ_FTS_INSERT AFTER INSERT ON FAQ BEGIN "
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) "
+             "VALUES (new.ROWID, faq_text(new.QUESTION), faq_text(new.REPONSE)); END",
+             "CREATE TRIGGER IF NOT EXISTS FAQ_FTS_DELETE AFTER DELETE ON FAQ BEGIN "
+             "DELETE FROM FAQ_FTS WHERE rowid = old.ROWID; END",
+             "CREATE TRIGGER IF NOT EXISTS FAQ_FTS_UPDATE AFTER UPDATE ON FAQ BEGIN "
+             "DELETE FROM FAQ_FTS WHERE rowid = old.ROWID; "
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) "
+             "VALUES (new.ROWID, faq_text(new.QUESTION), faq_text(new.REPONSE)); END",
+             // réindexation complète des Q/R existantes.
+             "DELETE FROM FAQ_FTS",
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) "
+             "SELECT ROWID, faq_text(QUESTION), faq_text(REPONSE) FROM FAQ"},
+            // 3 : index partiel des seules Q/R validées, ses entrées sont classées par ROWID.
+            {"CREATE INDEX IF NOT EXISTS FAQ_VALIDE ON FAQ(REPONSE_VALIDE) WHERE REPONSE_VALIDE = 1"},
+            // 4 : triggers sans faq_text(), fonction propre à la connexion de l'application : toute autre connexion
+            // modifiant la table FAQ échouait. Le html est désormais indexé tel quel.
+            {"DROP TRIGGER IF EXISTS FAQ_FTS_INSERT", "DROP TRIGGER IF EXISTS FAQ_FTS_UPDATE",
+             "CREATE TRIGGER FAQ_FTS_INSERT AFTER INSERT ON FAQ BEGIN "
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) VALUES (new.ROWID, new.QUESTION, new.REPONSE); END",
+             "CREATE TRIGGER FAQ_FTS_UPDATE AFTER UPDATE ON FAQ BEGIN "
+             "DELETE FROM FAQ_FTS WHERE rowid = old.ROWID; "
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) VALUES (new.ROWID, new.QUESTION, new.REPONSE); END",
+             "DELETE FROM FAQ_FTS",
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) SELECT ROWID, QUESTION, REPONSE FROM FAQ"},
+            // 5 : ROWID déclaré INTEGER PRIMARY KEY, sans quoi un VACUUM peut renuméroter les Q/R (désynchronisant
+            // FAQ_FTS et les liens par numéro de ligne). La table est recréée avec les mêmes ROWID, ses triggers et
+            // son index avec elle.
+            {"CREATE TABLE FAQ_NEW (ROWID INTEGER PRIMARY KEY, QUESTION TEXT, REPONSE TEXT, DATE_AJOUT_QUESTION TEXT, "
+             "DATE_AJOUT_REPONSE TEXT, REPONSE_VALIDE INTEGER DEFAULT 0)",
+             "INSERT INTO FAQ_NEW (ROWID, QUESTION, REPONSE, DATE_AJOUT_QUESTION, DATE_AJOUT_REPONSE, REPONSE_VALIDE) "
+             "SELECT ROWID, QUESTION, REPONSE, DATE_AJOUT_QUESTION, DATE_AJOUT_REPONSE, REPONSE_VALIDE FROM FAQ",
+             "DROP TABLE FAQ", "ALTER TABLE FAQ_NEW RENAME TO FAQ",
+             "CREATE INDEX FAQ_VALIDE ON FAQ(REPONSE_VALIDE) WHERE REPONSE_VALIDE = 1",
+             "CREATE TRIGGER FAQ_FTS_INSERT AFTER INSERT ON FAQ BEGIN "
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) VALUES (new.ROWID, new.QUESTION, new.REPONSE); END",
+             "CREATE TRIGGER FAQ_FTS_DELETE AFTER DELETE ON FAQ BEGIN "
+             "DELETE FROM FAQ_FTS WHERE rowid = old.ROWID; END",
+             "CREATE TRIGGER FAQ_FTS_UPDATE AFTER UPDATE ON FAQ BEGIN "
+             "DELETE FROM FAQ_FTS WHERE rowid = old.ROWID; "
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) VALUES (new.ROWID, new.QUESTION, new.REPONSE); END"},
+            // 6 : ligatures et lettres que unicode61 ne décompose pas repliées comme par Tokenizer::tokenize, pour que
+            // "coeur" trouve "cœur".
+            {"DROP TRIGGER FAQ_FTS_INSERT", "DROP TRIGGER FAQ_FTS_UPDATE",
+             "CREATE TRIGGER FAQ_FTS_INSERT AFTER INSERT ON FAQ BEGIN "
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) VALUES (new.ROWID, " +
+                 foldSql("new.QUESTION") + ", " + foldSql("new.REPONSE") + "); END",
+             "CREATE TRIGGER FAQ_FTS_UPDATE AFTER UPDATE ON FAQ BEGIN "
+             "DELETE FROM FAQ_FTS WHERE rowid = old.ROWID; "
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) VALUES (new.ROWID, " +
+                 foldSql("new.QUESTION") + ", " + foldSql("new.REPONSE") + "); END",
+             "DELETE FROM FAQ_FTS",
+             "INSERT INTO FAQ_FTS(rowid, QUESTION, REPONSE) SELECT ROWID, " + foldSql("QUESTION") + ", " +
+                 foldSql("REPONSE") + " FROM FAQ"},
+        };
 
-        try
+        int version = db.execAndGet("PRAGMA user_version").getInt();
+        for (std::size_t step = version; step < steps.size(); step++)
         {
-            // Open a database file
-            SQLite::Database db(mDatabase);
+            for (const auto &sql : steps[step])
+                db.exec(sql);
+            std::cout << "schéma SQLite : migration " << step + 1 << " appliquée" << std::endl;
+        }
+        if (static_cast<std::size_t>(version) < steps.size())
+            db.exec("PRAGMA user_version = " + std::to_string(steps.size()));
+    }
+    /*
+     * Expression SQL repliant les caractères latins que le tokenizer unicode61 ne décompose pas (œ, æ, ø, ß, ð, þ et
+     * leurs majuscules), avec la même correspondance que Tokenizer::foldLatin1. N'utilise que replace(), fonction
+     * intégrée à SQLite, les triggers restant exécutables par toute connexion. Utilisée par la migration 6.
+     * @param column : colonne ou expression SQL à replier.
+     * @return l'expression SQL.
+     */
+    static std::string foldSql(const std::string &column)
+    {
+        static const std::pair<const char *, const char *> folds[] = {
+            {"Œ", "oe"}, {"œ", "oe"}, {"Æ", "ae"}, {"æ", "ae"}, {"Ø", "o"},  {"ø", "o"},
+            {"ß", "ss"}, {"Ð", "d"},  {"ð", "d"},  {"Þ", "th"}, {"þ", "th"}};
+        std::string expression = column;
+        for (const auto &[from, to] : folds)
+            expression = std::string("replace(") + expression + ", '" + from + "', '" + to + "')";
+        return expression;
+    }
+    /*
+     * Exécution d'une requête de lecture sur la connexion du thread appelant.
+     * @param request : requête (préparée une seule fois par connexion).
+     * @param parameters : valeurs des paramètres (?) de la requête, dans l'ordre.
+     * @return les Q/R lues ou null en cas d'erreur.
+     */
+    std::optional<std::vector<FAQRow>> fetchAndMapResults(const std::string &request,
+                                                          const std::vector<int64_t> &parameters = {})
+    {
 
-            // Compile a SQL query, containing one parameter (index 1)
-            SQLite::Statement query(db, request);
+        try
+        {
+            SQLite::Statement &query = mConnections.reader().prepare(request);
+            for (std::size_t i = 0; i < parameters.size(); i++)
+                query.bind(static_cast<int>(i + 1), parameters[i]);
 
             std::vector<FAQRow> retourRequete;
             // Loop to execute the query step by step, to get rows of result
             while (query.executeStep())
-            {
-                FAQRow row;
-
-                row.ROWID = query.getColumn(0);
-                row.QUESTION = std::string(query.getColumn(1));
-                row.REPONSE = std::string(query.getColumn(2));
-                row.DATE_AJOUT_QUESTION = std::string(query.getColumn(3));
-                row.DATE_AJOUT_REPONSE = std::string(query.getColumn(4));
-                row.REPONSE_VALIDE = (unsigned int)query.getColumn(5) == 1 ? true : false;
-                retourRequete.push_back(row);
-            }
+                retourRequete.push_back(mapRow(query));
+            // la requête terminée ne retient plus la base.
+            query.reset();
             return {retourRequete};
         }
         catch (std::exception &e)
@@ -122,6 +366,65 @@ class SqliteDataAccess : public IDataAccess
         }
         return std::nullopt;
     }
-    std::string mDatabase;
+    /*
+     * Conversion de la ligne courante d'une requête (ROWID, QUESTION, REPONSE, DATE_AJOUT_QUESTION,
+     * DATE_AJOUT_REPONSE, REPONSE_VALIDE) en FAQRow.
+     */
+    static FAQRow mapRow(SQLite::Statement &query)
+    {
+        FAQRow row;
+
+        row.ROWID = query.getColumn(0);
+        row.QUESTION = std::string(query.getColumn(1));
+        row.REPONSE = std::string(query.getColumn(2));
+        row.DATE_AJOUT_QUESTION = std::string(query.getColumn(3));
+        row.DATE_AJOUT_REPONSE = std::string(query.getColumn(4));
+        row.REPONSE_VALIDE = (unsigned int)query.getColumn(5) == 1 ? true : false;
+        return row;
+    }
+    /*
+     * Extrait html d'une réponse : l'extrait de FTS5 est découpé dans le html brut et peut donc commencer ou finir au
+     * milieu d'une balise. Les balises sont retirées avant que les marqueurs des termes trouvés deviennent des <mark>.
+     * @param snippet : extrait retourné par snippet(), termes trouvés entre \x02 et \x03.
+     * @return l'extrait, sans autres balises que <mark>.
+     */
+    static std::string snippetHtml(std::string snippet)
+    {
+        static const std::string ellipsis = "…";
+        bool cut = snippet.starts_with(ellipsis);
+        if (cut)
+            snippet.erase(0, ellipsis.size());
+        // fin d'une balise commencée avant l'extrait.
+        auto close = snippet.find('>');
+        if (close != std::string::npos && close < snippet.find('<'))
+            snippet.erase(0, close + 1);
+
+        std::string html = cut ? ellipsis : "";
+        for (char c : Tokenizer::plainText(snippet))
+        {
+            if (c == '\x02')
+                html += "<mark>";
+            else if (c == '\x03')
+                html += "</mark>";
+            else
+                html += c;
+        }
+        return html;
+    }
+    /*
+     * Fonction SQL faq_text(html) : texte sans balises (index FAQ_FTS de la migration 2).
+     */
+    static void sqlPlainText(sqlite3_context *context, int, sqlite3_value **values)
+    {
+        auto html = reinterpret_cast<const char *>(sqlite3_value_text(values[0]));
+        if (html == nullptr)
+        {
+            sqlite3_result_null(context);
+            return;
+        }
+        std::string text = Tokenizer::plainText(html);
+        sqlite3_result_text(context, text.data(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+    }
+    SqliteConnectionPool mConnections;
 };
 #endif
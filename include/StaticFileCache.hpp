@@ -0,0 +1,76 @@
+#ifndef FAQ_STATICFILECACHE_HPP
+#define FAQ_STATICFILECACHE_HPP
+#include "EncodedContent.hpp"
+#include "Tools.hpp"
+#include <crow.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+/*
+ * Cache des fichiers statiques.
+ * Tous les fichiers du dossier sont lus et compressés une seule fois au démarrage, les réponses servent ensuite
+ * directement la variante adaptée au client.
+ */
+class StaticFileCache
+{
+  public:
+    /*
+     * Constructeur, charge et compresse tous les fichiers du dossier (récursivement).
+     * @param pDirectory : dossier des fichiers statiques.
+     */
+    StaticFileCache(const std::string &pDirectory = "static/")
+    {
+        for (const auto &entry : std::filesystem::recursive_directory_iterator(pDirectory))
+        {
+            if (!entry.is_regular_file())
+                continue;
+            std::ifstream file(entry.path(), std::ios::binary);
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+
+            std::string extension = entry.path().extension().string();
+            if (!extension.empty())
+                extension.erase(0, 1);
+            std::string mimeType = crow::mime_types.count(extension) ? crow::mime_types.at(extension) : "text/plain";
+
+            auto lastWrite = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                std::chrono::file_clock::to_sys(entry.last_write_time()));
+            auto lastModified = Tools::httpDate(std::chrono::system_clock::to_time_t(lastWrite));
+
+            std::string path = std::filesystem::relative(entry.path(), pDirectory).generic_string();
+            mFiles.emplace(path, EncodedContent(mimeType, buffer.str(), lastModified, isCompressible(mimeType)));
+        }
+        std::cout << mFiles.size() << " fichiers statiques chargés" << std::endl;
+    }
+    /*
+     * Réponse HTTP pour un fichier statique.
+     * @param request : la requête du client.
+     * @param path : chemin du fichier relatif au dossier.
+     * @return le fichier, ou 404 s'il est inconnu.
+     */
+    crow::response respond(const crow::request &request, const std::string &path) const
+    {
+        auto found = mFiles.find(path);
+        if (found == mFiles.end())
+            return crow::response(404);
+        // les clients peuvent garder les fichiers en cache une heure avant de les revalider.
+        return found->second.respond(request, "public, max-age=3600");
+    }
+
+  private:
+    /*
+     * @param mimeType : type MIME du fichier.
+     * @return faux pour les formats déjà compressés (images matricielles, polices, archives ...).
+     */
+    static bool isCompressible(const std::string &mimeType)
+    {
+        return mimeType.starts_with("text/") || mimeType.find("javascript") != std::string::npos ||
+               mimeType.find("json") != std::string::npos || mimeType.find("xml") != std::string::npos;
+    }
+    // fichiers par chemin relatif, la map n'est plus modifiée après le constructeur.
+    std::map<std::string, EncodedContent> mFiles;
+};
+#endif
@@ -0,0 +1,297 @@
+#ifndef FAQ_TEMPLATEMANAGER_HPP
+#define FAQ_TEMPLATEMANAGER_HPP
+#include <atomic>
+#include <cerrno>
+#include <crow/mustache.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <thread>
+#include <unistd.h>
+/*
+ * Ensemble des templates compilés à un instant donné.
+ */
+struct TemplateSet
+{
+    // templates compilés, partials intégrés, par nom de fichier.
+    std::map<std::string, crow::mustache::template_t> templates;
+    // texte brut des templates, intégré dans les templates qui les incluent comme partials.
+    std::map<std::string, std::string> texts;
+    // numéro de version, incrémenté à chaque rechargement.
+    uint64_t version{0};
+};
+/*
+ * Classe de gestion des templates mustache.
+ * Les templates du dossier sont compilés une seule fois puis partagés en lecture seule par tous les threads.
+ * Les partials ({{>fichier}}) sont intégrés au texte avant la compilation, comme le fait mustache2cpp : crow ne
+ * les recompile donc pas à chaque rendu.
+ * Un thread surveille le dossier via inotify et recompile les templates dès qu'un fichier est modifié,
+ * le nouvel ensemble remplaçant l'ancien de façon atomique.
+ */
+class TemplateManager
+{
+  public:
+    /*
+     * Constructeur, compile tous les templates du dossier et démarre la surveillance.
+     * @param pDirectory : dossier des templates.
+     */
+    TemplateManager(const std::string &pDirectory = "templates/") : mDirectory(pDirectory)
+    {
+        if (mDirectory.empty() || mDirectory.back() != '/')
+            mDirectory += '/';
+
+        auto templateSet = std::make_shared<TemplateSet>();
+        for (const auto &entry : std::filesystem::directory_iterator(mDirectory))
+        {
+            if (entry.is_regular_file() && isTemplate(entry.path().filename().string()))
+                readInto(*templateSet, entry.path().filename().string());
+        }
+        for (const auto &[name, text] : templateSet->texts)
+            compileInto(*templateSet, name);
+        mTemplates.store(std::move(templateSet));
+
+        // les partials qui n'ont pas pu être intégrés sont servis depuis la mémoire plutôt que relus sur le disque.
+        crow::mustache::set_loader([this](const std::string &name) { return loadText(name); });
+
+        startWatching();
+    }
+    TemplateManager(const TemplateManager &) = delete;
+    TemplateManager &operator=(const TemplateManager &) = delete;
+
+    ~TemplateManager()
+    {
+        if (mStopFd >= 0)
+        {
+            uint64_t one = 1;
+            write(mStopFd, &one, sizeof(one));
+        }
+        if (mWatchThread.joinable())
+            mWatchThread.join();
+        if (mInotifyFd >= 0)
+            close(mInotifyFd);
+        if (mStopFd >= 0)
+            close(mStopFd);
+        crow::mustache::set_loader(crow::mustache::default_loader);
+    }
+    /*
+     * @return l'ensemble courant des templates compilés, à conserver le temps du rendu.
+     */
+    std::shared_ptr<const TemplateSet> getTemplates() const
+    {
+        return mTemplates.load();
+    }
+    /*
+     * Rendu d'un template compilé.
+     * @param name : nom du fichier du template.
+     * @param ctx : contexte de rendu.
+     * @return le rendu, vide si le template est inconnu.
+     */
+    crow::mustache::rendered_template render(const std::string &name, const crow::mustache::context &ctx) const
+    {
+        auto templateSet = getTemplates();
+        auto found = templateSet->templates.find(name);
+        if (found == templateSet->templates.end())
+        {
+            std::cout << "template inconnu : " << name << std::endl;
+            return crow::mustache::rendered_template();
+        }
+        return found->second.render(ctx);
+    }
+
+  private:
+    /*
+     * Filtre les fichiers du dossier (fichiers temporaires des éditeurs notamment).
+     * @param name : nom du fichier.
+     * @return vrai si le fichier est un template html.
+     */
+    static bool isTemplate(const std::string &name)
+    {
+        return !name.empty() && name.front() != '.' && name.ends_with(".html");
+    }
+    /*
+     * Lecture du texte d'un template dans l'ensemble fourni.
+     * @return vrai si le fichier a été lu.
+     */
+    bool readInto(TemplateSet &templateSet, const std::string &name)
+    {
+        std::ifstream file(mDirectory + name);
+        if (!file)
+            return false;
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        templateSet.texts.insert_or_assign(name, buffer.str());
+        return true;
+    }
+    /*
+     * Compilation d'un template de l'ensemble fourni, ses partials intégrés depuis les textes du même ensemble.
+     * @return vrai si le template a été compilé, faux sinon (l'éventuelle version précédente est conservée).
+     */
+    bool compileInto(TemplateSet &templateSet, const std::string &name)
+    {
+        try
+        {
+            auto compiled = crow::mustache::compile(expandPartials(templateSet, templateSet.texts.at(name)));
+            templateSet.templates.insert_or_assign(name, std::move(compiled));
+            return true;
+        }
+        catch (const crow::mustache::invalid_template_exception &e)
+        {
+            std::cout << "template " << name << " invalide : " << e.what() << std::endl;
+        }
+        return false;
+    }
+    /*
+     * Remplacement des balises {{>fichier}} par le texte du partial, avec les règles de crow::mustache : un partial
+     * seul sur sa ligne remplace la ligne entière et chacune de ses lignes reçoit l'indentation de la balise.
+     * Un partial absent de l'ensemble est laissé tel quel, il sera chargé par crow au rendu.
+     * @param body : texte du template.
+     * @param depth : profondeur d'imbrication des partials.
+     * @return le texte, partials intégrés.
+     */
+    static std::string expandPartials(const TemplateSet &templateSet, const std::string &body, int depth = 0)
+    {
+        if (depth > MAX_PARTIAL_DEPTH)
+            throw crow::mustache::invalid_template_exception("partials imbriqués trop profondément");
+
+        std::string expanded;
+        std::size_t current = 0;
+        std::size_t open;
+        while ((open = body.find("{{>", current)) != std::string::npos)
+        {
+            std::size_t close = body.find("}}", open);
+            if (close == std::string::npos)
+                break;
+            std::string name = body.substr(open + 3, close - open - 3);
+            name.erase(0, name.find_first_not_of(' '));
+            name.erase(name.find_last_not_of(' ') + 1);
+            auto partial = templateSet.texts.find(name);
+            if (partial == templateSet.texts.end())
+            {
+                expanded.append(body, current, close + 2 - current);
+                current = close + 2;
+                continue;
+            }
+
+            // balise seule sur sa ligne (espaces uniquement avant et après) : la ligne entière est remplacée.
+            std::size_t lineStart = open == 0 ? std::string::npos : body.rfind('\n', open - 1);
+            lineStart = lineStart == std::string::npos ? 0 : lineStart + 1;
+            std::size_t after = body.find_first_not_of(' ', close + 2);
+            bool standalone = lineStart >= current && body.find_first_not_of(' ', lineStart) == open &&
+                              (after == std::string::npos || body.compare(after, 1, "\n") == 0 ||
+                               body.compare(after, 2, "\r\n") == 0);
+            std::string text = expandPartials(templateSet, partial->second, depth + 1);
+            if (standalone)
+            {
+                std::string indentation(open - lineStart, ' ');
+                expanded.append(body, current, lineStart - current);
+                for (std::size_t start = 0; start < text.size();)
+                {
+                    std::size_t end = text.find('\n', start);
+                    end = end == std::string::npos ? text.size() : end + 1;
+                    expanded += indentation;
+                    expanded.append(text, start, end - start);
+                    start = end;
+                }
+                current = after == std::string::npos ? body.size() : body.find('\n', after) + 1;
+            }
+            else
+            {
+                expanded.append(body, current, open - current);
+                expanded += text;
+                current = close + 2;
+            }
+        }
+        expanded.append(body, current);
+        return expanded;
+    }
+    /*
+     * Loader mustache : texte en mémoire, ou lecture disque pour un fichier inconnu.
+     */
+    std::string loadText(const std::string &name) const
+    {
+        auto templateSet = getTemplates();
+        auto found = templateSet->texts.find(name);
+        if (found != templateSet->texts.end())
+            return found->second;
+        return crow::mustache::default_loader(name);
+    }
+    /*
+     * Recompile un template modifié, ainsi que les templates qui l'incluent, et publie un nouvel ensemble.
+     */
+    void reload(const std::string &name)
+    {
+        auto templateSet = std::make_shared<TemplateSet>(*getTemplates());
+        if (!readInto(*templateSet, name) || !compileInto(*templateSet, name))
+            return;
+        for (const auto &[other, text] : templateSet->texts)
+            if (other != name)
+                compileInto(*templateSet, other);
+        templateSet->version++;
+        mTemplates.store(std::move(templateSet));
+        std::cout << "template " << name << " rechargé" << std::endl;
+    }
+    /*
+     * Démarrage du thread de surveillance inotify du dossier des templates.
+     */
+    void startWatching()
+    {
+        mInotifyFd = inotify_init1(IN_CLOEXEC);
+        mStopFd = eventfd(0, EFD_CLOEXEC);
+        if (mInotifyFd < 0 || mStopFd < 0 ||
+            inotify_add_watch(mInotifyFd, mDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            std::cout << "surveillance des templates impossible, rechargement à chaud désactivé" << std::endl;
+            return;
+        }
+        mWatchThread = std::thread([this]() { watch(); });
+    }
+    /*
+     * Boucle du thread de surveillance, jusqu'à la demande d'arrêt (mStopFd) ou une erreur de poll.
+     */
+    void watch()
+    {
+        alignas(inotify_event) char buffer[4096];
+        pollfd fds[2] = {{mInotifyFd, POLLIN, 0}, {mStopFd, POLLIN, 0}};
+        while (true)
+        {
+            if (poll(fds, 2, -1) < 0)
+            {
+                // attente interrompue par un signal : elle reprend.
+                if (errno == EINTR)
+                    continue;
+                std::cout << "surveillance des templates arrêtée, rechargement à chaud désactivé : "
+                          << std::strerror(errno) << std::endl;
+                return;
+            }
+            if (fds[1].revents & POLLIN)
+                return;
+            ssize_t length = read(mInotifyFd, buffer, sizeof(buffer));
+            for (ssize_t i = 0; i < length;)
+            {
+                auto *event = reinterpret_cast<const inotify_event *>(buffer + i);
+                if (event->len > 0 && isTemplate(event->name))
+                    reload(event->name);
+                i += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+
+    // profondeur maximum d'imbrication des partials (protège d'un partial qui s'inclut lui-même).
+    static constexpr int MAX_PARTIAL_DEPTH = 16;
+
+    std::string mDirectory;
+    // ensemble courant, lu sans verrou par les threads de requête.
+    std::atomic<std::shared_ptr<const TemplateSet>> mTemplates;
+    int mInotifyFd{-1};
+    int mStopFd{-1};
+    std::thread mWatchThread;
+};
+#endif
@@ -0,0 +1,176 @@
+#ifndef FAQ_TOKENIZER_HPP
+#define FAQ_TOKENIZER_HPP
+#include <cctype>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+/*
+ * Découpage d'un texte français en termes pour la recherche : passage en minuscules, suppression des accents,
+ * des balises html et des mots vides (articles, prépositions, pronoms ...).
+ */
+class Tokenizer
+{
+  public:
+    /*
+     * Découpage d'un texte en termes.
+     * @param text : texte en UTF-8, éventuellement html.
+     * @param keepStopWords : conserve les mots vides (utile pour la saisie en cours d'une recherche).
+     * @return les termes normalisés, dans l'ordre du texte.
+     */
+    static std::vector<std::string> tokenize(std::string_view text, bool keepStopWords = false)
+    {
+        std::vector<std::string> tokens;
+        std::string current;
+        auto flush = [&]() {
+            if (!current.empty() && (keepStopWords || !isStopWord(current)))
+                tokens.push_back(current);
+            current.clear();
+        };
+
+        for (std::size_t i = 0; i < text.size(); i++)
+        {
+            unsigned char c = text[i];
+            if (c == '<')
+            {
+                // balise html : ignorée jusqu'au '>'.
+                flush();
+                auto end = text.find('>', i);
+                i = end == std::string_view::npos ? text.size() : end;
+            }
+            else if (c == '&')
+            {
+                // entité html (&eacute; &nbsp; ...) : traitée comme un séparateur.
+                flush();
+                auto end = text.find_first_of("; ", i);
+                if (end != std::string_view::npos && end - i <= 10 && text[end] == ';')
+                    i = end;
+            }
+            else if (c < 0x80)
+            {
+                if (std::isalnum(c))
+                    current += static_cast<char>(std::tolower(c));
+                else
+                    flush();
+            }
+            else if (c == 0xC3 && i + 1 < text.size())
+            {
+                // lettres latines accentuées (U+00C0 à U+00FF).
+                std::string_view folded = foldLatin1(static_cast<unsigned char>(text[++i]));
+                if (folded.empty())
+                    flush();
+                else
+                    current += folded;
+            }
+            else if (c == 0xC2 && i + 1 < text.size())
+            {
+                // espace insécable, guillemets « », ponctuation et symboles latin-1 (U+0080 à U+00BF) : séparateur.
+                flush();
+                i += 1;
+            }
+            else if (c == 0xC5 && i + 1 < text.size() &&
+                     (static_cast<unsigned char>(text[i + 1]) == 0x92 ||
+                      static_cast<unsigned char>(text[i + 1]) == 0x93))
+            {
+                // Œ œ
+                current += "oe";
+                i++;
+            }
+            else if (c == 0xE2 && i + 2 < text.size() && static_cast<unsigned char>(text[i + 1]) == 0x80)
+            {
+                // ponctuation générale (apostrophe typographique, tirets, guillemets ...) : séparateur.
+                flush();
+                i += 2;
+            }
+            else if (c == 0xE2 && i + 2 < text.size() && isCurrencySign(text[i + 1], text[i + 2]))
+            {
+                // symboles monétaires (€ ...) : séparateur, comme pour le tokenizer unicode61 de l'index SQLite.
+                flush();
+                i += 2;
+            }
+            else
+            {
+                // autres caractères non ASCII conservés tels quels (octet par octet).
+                current += static_cast<char>(c);
+            }
+        }
+        flush();
+        return tokens;
+    }
+    /*
+     * Texte d'un contenu html : les balises sont supprimées (remplacées par un espace entre deux mots), les espaces
+     * consécutifs sont regroupés.
+     * @param html : contenu en UTF-8.
+     * @return le texte, sans balise.
+     */
+    static std::string plainText(std::string_view html)
+    {
+        std::string text;
+        text.reserve(html.size());
+        bool space = false;
+        bool tag = false;
+        for (std::size_t i = 0; i < html.size(); i++)
+        {
+            unsigned char c = html[i];
+            if (c == '<')
+            {
+                auto end = html.find('>', i);
+                i = end == std::string_view::npos ? html.size() : end;
+                tag = true;
+            }
+            else if (std::isspace(c))
+                space = true;
+            else
+            {
+                // pas d'espace ajouté entre un mot et la ponctuation qui suit sa balise (<b>mot</b>, ...).
+                if (!text.empty() && (space || (tag && !std::ispunct(c))))
+                    text += ' ';
+                text += static_cast<char>(c);
+                space = tag = false;
+            }
+        }
+        return text;
+    }
+    /*
+     * @param term : terme normalisé.
+     * @return vrai si le terme est un mot vide.
+     */
+    static bool isStopWord(const std::string &term)
+    {
+        static const std::unordered_set<std::string> stopWords = {
+            "a", "ai", "au", "aux", "avec", "c", "ce", "ces", "cet", "cette", "comment", "d", "dans", "de", "des",
+            "du", "elle", "elles", "en", "est", "et", "etre", "eux", "il", "ils", "j", "je", "l", "la", "le", "les",
+            "leur", "leurs", "lui", "m", "ma", "mais", "me", "mes", "moi", "mon", "n", "ne", "nos", "notre", "nous",
+            "on", "ou", "par", "pas", "pour", "qu", "quel", "quelle", "quelles", "quels", "que", "qui", "quoi", "s",
+            "sa", "se", "ses", "son", "sont", "sur", "t", "ta", "te", "tes", "toi", "ton", "tu", "un", "une", "vos",
+            "votre", "vous", "y"};
+        return stopWords.count(term) > 0;
+    }
+
+  private:
+    /*
+     * @return vrai si les octets suivant 0xE2 codent un symbole monétaire (U+20A0 à U+20CF).
+     */
+    static bool isCurrencySign(char second, char third)
+    {
+        auto b1 = static_cast<unsigned char>(second);
+        auto b2 = static_cast<unsigned char>(third);
+        return (b1 == 0x82 && b2 >= 0xA0 && b2 <= 0xBF) || (b1 == 0x83 && b2 >= 0x80 && b2 <= 0x8F);
+    }
+    /*
+     * Suppression de l'accent d'une lettre U+00C0 à U+00FF (second octet de la séquence UTF-8 0xC3 xx).
+     * @return la lettre sans accent en minuscule, vide pour les symboles (×, ÷).
+     */
+    static std::string_view foldLatin1(unsigned char c)
+    {
+        static const char *const table[64] = {
+            "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i",  "i", // C0-CF
+            "d", "n", "o", "o", "o", "o", "o",  "",  "o", "u", "u", "u", "u", "y", "th", "ss", // D0-DF
+            "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i",  "i", // E0-EF
+            "d", "n", "o", "o", "o", "o", "o",  "",  "o", "u", "u", "u", "u", "y", "th", "y"}; // F0-FF
+        if (c < 0x80 || c > 0xBF)
+            return {};
+        return table[c - 0x80];
+    }
+};
+#endif
@@ -2,12 +2,14 @@
 #define FAQ_TOOLS_HPP
 #include "FAQRow.hpp"
 #include "jwt-cpp/jwt.h"
+#include <cctype>
 #include <chrono>
 #include <crow.h>
 #include <cstring>
 #include <iomanip>
 #include <openssl/evp.h>
 #include <openssl/sha.h>
+#include <optional>
 #include <regex>
 /*
  * Classe utilitaire.
@@ -33,15 +35,16 @@ class Tools
         return retour;
     }
     /*
-     * Conversion de vector vers list de wvalue. S'appuie sur la méthode convertToWValue.
+     * Conversion de vector (ou de toute autre séquence, span ...) vers list de wvalue. S'appuie sur la méthode
+     * convertToWValue.
      * @param list : liste à convertir.
      * @return vecteur de wvalue.
      */
-    template <typename T> static crow::json::wvalue convertListToWValue(const std::vector<T> &list)
+    template <typename List> static crow::json::wvalue convertListToWValue(const List &list)
     {
         std::vector<crow::json::wvalue> listValue;
         std::for_each(list.begin(), list.end(),
-                      [&listValue](const T &value) { listValue.push_back(convertToWValue(value)); });
+                      [&listValue](const auto &value) { listValue.push_back(convertToWValue(value)); });
 
         return crow::json::wvalue(crow::json::wvalue::list(listValue));
     }
@@ -150,6 +153,19 @@ class Tools
      */
     static std::string JWTToken(const std::string &iss, const std::string &scope, const std::string &aud,
                                 const std::string &pkey)
+    {
+        return JWTToken(iss, scope, aud, jwt::algorithm::rs256("", pkey, "", ""));
+    }
+    /*
+     * Méthode de création d'un token JWT avec un algorithme de signature déjà construit (la clé privée n'est pas
+     * relue à chaque appel).
+     * @param iss : issuer.
+     * @param scope : scope du jeton.
+     * @param aud : audience du jeton.
+     * @param signer : algorithme de signature contenant la clé privée.
+     */
+    static std::string JWTToken(const std::string &iss, const std::string &scope, const std::string &aud,
+                                const jwt::algorithm::rs256 &signer)
     {
         auto token = jwt::create()
                          .set_issuer(iss)
@@ -159,9 +175,91 @@ class Tools
                          .set_expires_in(std::chrono::seconds{1800})
                          .set_payload_claim("scope", picojson::value(scope))
                          .set_audience(aud)
-                         .sign(jwt::algorithm::rs256("", pkey, "", ""));
+                         .sign(signer);
         return token;
     }
+    /*
+     * Formatage d'un moment au format date HTTP (RFC 7231), ex : Sun, 06 Nov 1994 08:49:37 GMT.
+     * @param time : secondes depuis 01/01/1970.
+     * @return la date formatée.
+     */
+    static std::string httpDate(std::time_t time)
+    {
+        std::tm tm{};
+        gmtime_r(&time, &tm);
+        char buffer[64];
+        std::strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        return buffer;
+    }
+    /*
+     * Vérifie si un ETag fait partie de l'entête If-None-Match d'une requête.
+     * @param ifNoneMatch : valeur de l'entête (liste d'ETags séparés par des virgules, ou *).
+     * @param etag : ETag de la ressource.
+     * @return vrai si l'ETag correspond.
+     */
+    static bool etagMatches(const std::string &ifNoneMatch, const std::string &etag)
+    {
+        if (ifNoneMatch.empty())
+            return false;
+        if (ifNoneMatch == "*")
+            return true;
+        std::size_t start = 0;
+        while (start < ifNoneMatch.size())
+        {
+            std::size_t end = ifNoneMatch.find(',', start);
+            if (end == std::string::npos)
+                end = ifNoneMatch.size();
+            std::string_view candidate(ifNoneMatch.data() + start, end - start);
+            while (!candidate.empty() && candidate.front() == ' ')
+                candidate.remove_prefix(1);
+            while (!candidate.empty() && candidate.back() == ' ')
+                candidate.remove_suffix(1);
+            // comparaison faible (RFC 7232) : le préfixe W/ est ignoré.
+            if (candidate.starts_with("W/"))
+                candidate.remove_prefix(2);
+            if (candidate == etag)
+                return true;
+            start = end + 1;
+        }
+        return false;
+    }
+    /*
+     * Vérifie si un encodage est accepté par le client.
+     * Les noms d'encodage et le paramètre q sont comparés sans tenir compte de la casse (RFC 9110) : GZIP vaut gzip.
+     * @param acceptEncoding : valeur de l'entête Accept-Encoding (ex : gzip, deflate;q=0.5, br;q=0).
+     * @param encoding : encodage recherché, en minuscules.
+     * @return vrai si l'encodage est présent (ou couvert par *) avec une qualité non nulle, la qualité donnée
+     * explicitement pour l'encodage primant sur celle de * quel que soit l'ordre de la liste.
+     */
+    static bool acceptsEncoding(const std::string &acceptEncoding, const std::string &encoding)
+    {
+        std::optional<bool> accepted;
+        std::optional<bool> wildcard;
+        std::size_t start = 0;
+        while (start < acceptEncoding.size())
+        {
+            std::size_t end = acceptEncoding.find(',', start);
+            if (end == std::string::npos)
+                end = acceptEncoding.size();
+            std::string item = acceptEncoding.substr(start, end - start);
+            for (auto &c : item)
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            std::string_view name = std::string_view(item).substr(0, item.find(';'));
+            while (!name.empty() && name.front() == ' ')
+                name.remove_prefix(1);
+            while (!name.empty() && name.back() == ' ')
+                name.remove_suffix(1);
+            if (name == encoding || name == "*")
+            {
+                // une qualité q=0 signifie que l'encodage est refusé.
+                auto q = item.find("q=");
+                bool nonZero = q == std::string::npos || std::atof(item.c_str() + q + 2) > 0;
+                (name == "*" ? wildcard : accepted) = nonZero;
+            }
+            start = end + 1;
+        }
+        return accepted.value_or(wildcard.value_or(false));
+    }
     /*
     * Permet d'extraire un potentiel entier sous forme de string du body de la requête.
     * @param bodyParams : body de la requête.
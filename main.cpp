@@ -1,36 +1,87 @@
-#include "GoogleSheetDataAccess.hpp"
+#include "CachedDataAccess.hpp"
+#include "DataAccessFactory.hpp"
+#include "FAQRenderer.hpp"
 #include "IDataAccess.hpp"
+#include "PageCache.hpp"
+#include "QuestionSpool.hpp"
+#include "SearchIndex.hpp"
 #include "SecurityManager.hpp"
+#include "StaticFileCache.hpp"
+#include "TemplateManager.hpp"
 #include "Tools.hpp"
 #include <crow.h>
 #include <crow/mustache.h>
 using json = nlohmann::json;
-crow::mustache::rendered_template populateTemplate(const std::string &route, const crow::request &request,
-                                                   SecurityManager &sm, IDataAccess &dataAccess)
+crow::mustache::rendered_template populateTemplate(const FAQSnapshot &snapshot, bool askQuestion,
+                                                   std::size_t pageSize, SecurityManager &sm,
+                                                   const TemplateManager &templates)
 {
     crow::mustache::context ctx;
 
-    std::optional<std::vector<FAQRow>> allQr;
     // clé captchaClient pour génération d'un gToken via le widget recaptcha.
     ctx["captchaClient"] = sm.getCaptchaClient();
-    // détermine si l'ip du client a le droit de poser une question, si oui on affiche le champ,
-    // si non on le masque.
-    if (sm.showAskQuestion(request.remote_ip_address))
+    // si l'ip du client a le droit de poser une question on affiche le champ, si non on le masque.
+    if (askQuestion)
         ctx["askQuestion"] = "true";
 
-    // récupération de toutes les Q/R validées.
-    allQr = dataAccess.getAllValidated();
-
-    if (allQr.has_value())
+    // la photographie ne contient des Q/R validées qu'une fois le premier chargement effectué.
+    if (snapshot.version != 0)
     {
-        // Conversion puis affectation au template des Q/R retournées par la couche de données.
-        ctx["allQr"] = Tools::convertListToWValue(allQr.value());
+        std::span<const FAQRow> rows(snapshot.rows);
+        // seule la première page est rendue, les suivantes sont chargées par htmx via /faq/page/{n}.
+        if (pageSize != 0 && rows.size() > pageSize)
+        {
+            rows = rows.first(pageSize);
+            ctx["hasNextPage"] = true;
+            ctx["nextPage"] = 2;
+        }
+        // Conversion puis affectation au template des Q/R de la photographie.
+        ctx["allQr"] = Tools::convertListToWValue(rows);
         // Sers à alimenter un champ caché de comptage des réponses affichées.
-        ctx["numQuestion"] = allQr.value().size();
+        ctx["numQuestion"] = snapshot.rows.size();
     }
-    // on charge le template et on effectue le rendu html avec le contexte fourni.
-    auto page = crow::mustache::load("faq.mustache.html");
-    return page.render(ctx);
+    // rendu html avec le template déjà compilé et le contexte fourni.
+    return templates.render("faq.mustache.html", ctx);
+}
+/*
+ * Rendu d'un fragment de page (sections de Q/R) pour le chargement progressif par htmx.
+ * @param rows : Q/R de la page.
+ * @param nextPage : numéro de la page suivante (0 = dernière page).
+ */
+crow::mustache::rendered_template populatePageTemplate(std::span<const FAQRow> rows, unsigned int nextPage,
+                                                       const TemplateManager &templates)
+{
+    crow::mustache::context ctx;
+    ctx["allQr"] = Tools::convertListToWValue(rows);
+    if (nextPage != 0)
+    {
+        ctx["hasNextPage"] = true;
+        ctx["nextPage"] = nextPage;
+    }
+    return templates.render("faq_page.mustache.html", ctx);
+}
+/*
+ * Rendu des résultats d'une recherche.
+ * @param rows : Q/R trouvées, par ordre de pertinence.
+ */
+crow::mustache::rendered_template populateSearchTemplate(std::span<const FAQRow> rows, const TemplateManager &templates)
+{
+    crow::mustache::context ctx;
+    if (!rows.empty())
+        ctx["results"] = Tools::convertListToWValue(rows);
+    return templates.render("faq_search.mustache.html", ctx);
+}
+/*
+ * Rendu des suggestions de questions pendant la saisie.
+ * @param rows : Q/R suggérées.
+ */
+crow::mustache::rendered_template populateSuggestTemplate(const std::vector<FAQRow> &rows,
+                                                          const TemplateManager &templates)
+{
+    crow::mustache::context ctx;
+    if (!rows.empty())
+        ctx["suggestions"] = Tools::convertListToWValue(rows);
+    return templates.render("faq_suggest.mustache.html", ctx);
 }
 /*
  * Méthode principale.
@@ -46,7 +97,19 @@ crow::mustache::rendered_template populateTemplate(const std::string &route, con
   "tab":"Sheet1",
   "fields":"A1:G1",
   "serviceAccount":"xxx.Xxx@iam.gserviceaccount.com",
-  "privateKey":"--- private key ---"
+  "privateKey":"--- private key ---",
+  "refreshInterval":60,
+  "renderer":"mustache",
+  "pageSize":0,
+  "sheetsUrl":"https://sheets.googleapis.com",
+  "driveUrl":"https://www.googleapis.com",
+  "oauthUrl":"https://oauth2.googleapis.com",
+  "spoolFile":"questions.spool",
+  "backend":"replicated",
+  "database":"faq.db",
+  "sqlite":{"journalMode":"WAL","synchronous":"NORMAL","cacheSize":-16000,"mmapSize":268435456},
+  "snapshotFile":"faq.snapshot",
+  "chunkRows":2000
 }
 */
 int main(int argc, char *argv[])
@@ -65,13 +128,42 @@ int main(int argc, char *argv[])
         SecurityManager sm(data["captchaClient"], data["captchaSecret"], "oiedmin", "poissword",
                            data["visitorsAskingDelay"], data["visitorsCanAskQuestions"], data["ipProtection"]);
 
-        //    SqliteDataAccess da = SqliteDataAccess("faq.db");
-        //    Instanciation du IDataAccess GoogleSheetDataAccess avec les paramètres du fichier de configuration fourni.
-        GoogleSheetDataAccess gda = GoogleSheetDataAccess(data["spreadsheetId"], data["apikey"], data["tab"],
-                                                          data["privateKey"], data["serviceAccount"], data["fields"]);
+        // Instanciation de la couche de données choisie par la clé backend (google sheets, base SQLite locale ou
+        // feuille recopiée dans la base) avec les paramètres du fichier de configuration fourni.
+        std::optional<DataAccessFactory> backends;
+        try
+        {
+            backends.emplace(data);
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "configuration de la couche de données invalide : " << e.what() << std::endl;
+            return 1;
+        }
+
+        // Mise en cache des Q/R validées, rafraîchies en tâche de fond toutes les refreshInterval secondes.
+        // La dernière photographie est sauvegardée dans snapshotFile et relue au démarrage suivant.
+        CachedDataAccess cda(backends->getDataAccess(), std::chrono::seconds(data.value("refreshInterval", 60)),
+                             backends->getInitialData(), data.value("snapshotFile", "faq.snapshot"));
+
+        // Affectation du cache dans l'interface qui sera utilisée dans la suite du programme.
+        IDataAccess &dataAccess = cda;
+
+        // Journal des questions posées, transmises par lots en tâche de fond.
+        QuestionSpool questionSpool(dataAccess, data.value("spoolFile", "questions.spool"));
 
-        // Affectation du GoogleSheetDataAccess dans l'interface qui sera utilisée dans la suite du programme.
-        IDataAccess &dataAccess = gda;
+        // Compilation des templates et rechargement à chaud en cas de modification.
+        TemplateManager templates("templates/");
+        // Moteur de rendu de la page : template mustache interprété (par défaut) ou rendu direct des FAQRow.
+        bool directRenderer = data.value("renderer", "mustache") == "direct";
+        // Nombre de Q/R rendues dans la page, les suivantes étant chargées à la demande (0 = toutes).
+        std::size_t pageSize = data.value("pageSize", 0);
+        // Cache des pages rendues, servies compressées avec ETag.
+        PageCache pageCache;
+        // Fichiers statiques chargés et compressés une fois pour toutes.
+        StaticFileCache staticFiles("static/");
+        // Index plein texte des Q/R validées, mis à jour à partir de la photographie du cache.
+        SearchIndex searchIndex;
 
         // Défintion des routes HTTP.
         //
@@ -83,12 +175,134 @@ int main(int argc, char *argv[])
         //  Route principale de la faq, sert à afficher la liste des questions/réponses et éventuellement le formulaire
         //  de saisie d'une question.
         CROW_ROUTE(app, "/faq")
-        ([&sm, &dataAccess](const crow::request &request) {
-            return populateTemplate("/faq", request, sm, dataAccess);
+        ([&sm, &cda, &templates, &pageCache, directRenderer, pageSize](const crow::request &request) {
+            auto snapshot = cda.getSnapshot();
+            // détermine si l'ip du client a le droit de poser une question, ce qui donne deux variantes de la page.
+            bool askQuestion = sm.showAskQuestion(request.remote_ip_address);
+            auto page = pageCache.get(askQuestion ? "faq-question" : "faq", snapshot->version,
+                                      templates.getTemplates()->version, snapshot->lastModified, [&]() {
+                                          if (directRenderer)
+                                              return FAQRenderer::render(*snapshot, askQuestion, sm.getCaptchaClient(),
+                                                                         pageSize);
+                                          return populateTemplate(*snapshot, askQuestion, pageSize, sm, templates)
+                                              .body_;
+                                      });
+            return PageCache::respond(request, *page);
+        });
+
+        // Route des pages suivantes de la faq (fragments html ajoutés par htmx lors du défilement).
+        CROW_ROUTE(app, "/faq/page/<uint>")
+        ([&cda, &templates, &pageCache, directRenderer, pageSize](const crow::request &request,
+                                                                  unsigned int numPage) {
+            auto snapshot = cda.getSnapshot();
+            std::size_t offset = (numPage - 1) * pageSize;
+            // pagination désactivée ou page inexistante : rien n'est mis en cache.
+            if (pageSize == 0 || numPage < 2 || offset >= snapshot->rows.size())
+                return crow::response(404);
+            auto page = pageCache.get(
+                "page-" + std::to_string(numPage), snapshot->version, templates.getTemplates()->version,
+                snapshot->lastModified, [&]() {
+                    // la page est découpée dans la photographie dont la version sert de clé au cache.
+                    std::span<const FAQRow> rows(snapshot->rows);
+                    rows = rows.subspan(offset, std::min(pageSize, rows.size() - offset));
+                    unsigned int nextPage = offset + pageSize < snapshot->rows.size() ? numPage + 1 : 0;
+                    if (directRenderer)
+                        return FAQRenderer::renderPage(rows, nextPage);
+                    return populatePageTemplate(rows, nextPage, templates).body_;
+                });
+            return PageCache::respond(request, *page);
+        });
+
+        // Route de recherche plein texte (fragment html affiché par htmx sous le champ de recherche).
+        CROW_ROUTE(app, "/faq/search")
+        ([&cda, &searchIndex, &templates, directRenderer](const crow::request &request) {
+            const char *query = request.url_params.get("q");
+            std::vector<FAQRow> rows;
+            if (query != nullptr)
+            {
+                // recherche faite par la couche de données si elle en est capable (index FTS5 de la base SQLite),
+                // sinon par l'index en mémoire : seules les Q/R ajoutées ou modifiées depuis la dernière recherche
+                // y sont réindexées.
+                auto found = cda.search(query, 20);
+                if (!found.has_value())
+                {
+                    searchIndex.sync(*cda.getSnapshot());
+                    found = searchIndex.search(query);
+                }
+                rows = std::move(found.value());
+            }
+            crow::response response(directRenderer ? FAQRenderer::renderSearch(rows)
+                                                   : populateSearchTemplate(rows, templates).body_);
+            response.set_header("Content-Type", "text/html");
+            return response;
+        });
+
+        // Route des suggestions de questions, appelée à chaque frappe dans le champ de recherche.
+        CROW_ROUTE(app, "/faq/suggest")
+        ([&cda, &searchIndex, &templates, directRenderer](const crow::request &request) {
+            const char *query = request.url_params.get("q");
+            searchIndex.sync(*cda.getSnapshot());
+            auto rows = query == nullptr ? std::vector<FAQRow>() : searchIndex.suggest(query);
+            crow::response response(directRenderer ? FAQRenderer::renderSuggestions(rows)
+                                                   : populateSuggestTemplate(rows, templates).body_);
+            response.set_header("Content-Type", "text/html");
+            return response;
+        });
+
+        // Route d'une Q/R validée, affichée dans la zone des résultats de recherche lorsqu'une suggestion est choisie
+        // (avec la pagination, la Q/R n'est pas forcément sur une page déjà chargée).
+        CROW_ROUTE(app, "/faq/question/<uint>")
+        ([&cda, &templates, directRenderer](unsigned int rowid) {
+            auto snapshot = cda.getSnapshot();
+            auto row = std::find_if(snapshot->rows.begin(), snapshot->rows.end(),
+                                    [rowid](const FAQRow &faq) { return faq.ROWID == rowid; });
+            if (row == snapshot->rows.end())
+                return crow::response(404);
+            std::span<const FAQRow> rows(&*row, 1);
+            crow::response response(directRenderer ? FAQRenderer::renderSearch(rows)
+                                                   : populateSearchTemplate(rows, templates).body_);
+            response.set_header("Content-Type", "text/html");
+            return response;
+        });
+
+        // API JSON en lecture seule des Q/R validées, destinée aux autres services (chatbot, application mobile ...).
+        // Le json est sérialisé une seule fois par version de la photographie puis servi depuis le cache avec ETag.
+        CROW_ROUTE(app, "/api/faq")
+        ([&cda, &pageCache](const crow::request &request) {
+            auto snapshot = cda.getSnapshot();
+            // aucune donnée chargée : le client doit réessayer plus tard.
+            if (snapshot->version == 0)
+                return crow::response(503);
+            auto page = pageCache.get(
+                "api", snapshot->version, 0, snapshot->lastModified,
+                [&]() { return Tools::convertListToWValue(snapshot->rows).dump(); }, "application/json");
+            return PageCache::respond(request, *page);
+        });
+
+        // API JSON d'une Q/R validée.
+        CROW_ROUTE(app, "/api/faq/<uint>")
+        ([&cda, &pageCache](const crow::request &request, unsigned int rowid) {
+            auto snapshot = cda.getSnapshot();
+            auto row = std::find_if(snapshot->rows.begin(), snapshot->rows.end(),
+                                    [rowid](const FAQRow &faq) { return faq.ROWID == rowid; });
+            // Q/R inconnue ou non validée : rien n'est mis en cache.
+            if (row == snapshot->rows.end())
+                return crow::response(snapshot->version == 0 ? 503 : 404);
+            auto page = pageCache.get(
+                "api-" + std::to_string(rowid), snapshot->version, 0, snapshot->lastModified,
+                [&]() { return Tools::convertToWValue(*row).dump(); }, "application/json");
+            return PageCache::respond(request, *page);
+        });
+
+        // Route des fichiers statiques (remplace la route statique de Crow, désactivée via CROW_DISABLE_STATIC_DIR).
+        CROW_ROUTE(app, "/static/<path>")
+        ([&staticFiles](const crow::request &request, std::string path) {
+            return staticFiles.respond(request, path);
         });
 
         // Route permettant d'ajouter une question dans le stockage.
-        CROW_ROUTE(app, "/question").methods(crow::HTTPMethod::Post)([&dataAccess, &sm](const crow::request &req) {
+        CROW_ROUTE(app, "/question")
+            .methods(crow::HTTPMethod::Post)([&questionSpool, &sm](const crow::request &req) {
             std::string retour = "Erreur.";
             // On vérifie que l'IP source a le droit d'ajouter une question (normalement le formulaire est masqué mais
             // la route est toujours disponible coté serveur et doit donc être protégée).
@@ -105,7 +319,8 @@ int main(int argc, char *argv[])
                     std::string question = bodyParams.get("input-question");
                     if (question.length() <= 200)
                     {
-                        if (dataAccess.createQuestion(question, numQuestion + 1))
+                        // la question est enregistrée dans le journal puis transmise en tâche de fond.
+                        if (questionSpool.submit(question, numQuestion + 1))
                         {
                             // On enregistre l'IP dans le SecurityManager pour interdire de poser une nouvelle question
                             // pendant 24h
@@ -0,0 +1,79 @@
+#include "SqliteDataAccess.hpp"
+#include <filesystem>
+#include <iostream>
+#include <string>
+/*
+ * Tests du schéma SQLite : plans des lectures de Q/R validées, stabilité des ROWID, écriture par une autre connexion,
+ * repli des ligatures par l'index plein texte.
+ */
+static int failures = 0;
+
+static void check(bool condition, const std::string &message)
+{
+    if (condition)
+        return;
+    failures++;
+    std::cout << "échec : " << message << std::endl;
+}
+
+/*
+ * Vérification que le plan d'une requête passe par l'index partiel FAQ_VALIDE.
+ * @param db : connexion à la base de test.
+ * @param request : requête dont le plan est vérifié.
+ */
+static void checkPlan(SQLite::Database &db, const std::string &request)
+{
+    SQLite::Statement plan(db, "EXPLAIN QUERY PLAN " + request);
+    std::string details;
+    while (plan.executeStep())
+        details += plan.getColumn(3).getString() + "\n";
+    check(details.find("USING INDEX FAQ_VALIDE") != std::string::npos, "plan sans FAQ_VALIDE :\n" + details);
+}
+
+int main()
+{
+    auto path = std::filesystem::temp_directory_path() / "faq_sqlite_test.db";
+    std::filesystem::remove(path);
+    {
+        SqliteDataAccess access(path.string());
+        for (auto question : {"première", "deuxième", "troisième"})
+            access.createQuestion(question);
+        access.deleteQuestion(1);
+        access.updateQuestion(3, "<p>Une réponse</p>", true);
+    }
+    {
+        // écriture hors de l'application : les triggers de FAQ_FTS ne dépendent d'aucune fonction propre à celle-ci.
+        SQLite::Database db(path.string(), SQLite::OPEN_READWRITE);
+        try
+        {
+            db.exec("UPDATE FAQ SET REPONSE = '<p>Réponse saisie à la main</p>', REPONSE_VALIDE = 1 WHERE ROWID = 2");
+        }
+        catch (std::exception &e)
+        {
+            check(false, std::string("écriture externe : ") + e.what());
+        }
+        checkPlan(db, SqliteDataAccess::SELECT_VALIDATED);
+        checkPlan(db, SqliteDataAccess::SELECT_VALIDATED_PAGE);
+        // un VACUUM ne doit pas renuméroter les Q/R après une suppression.
+        db.exec("VACUUM");
+    }
+    {
+        SqliteDataAccess access(path.string());
+        auto rows = access.getAllValidated();
+        check(rows && rows->size() == 2 && (*rows)[0].ROWID == 2 && (*rows)[1].ROWID == 3, "ROWID après VACUUM");
+        auto found = access.search("main", 10);
+        check(found && found->size() == 1 && (*found)[0].ROWID == 2, "recherche après écriture externe");
+        // ligatures repliées dans l'index comme dans les termes cherchés.
+        access.updateQuestion(3, "<p>Le c\xC5\x93ur du sujet</p>", true);
+        for (auto query : {"coeur", "c\xC5\x93ur", "C\xC5\x92UR"})
+        {
+            found = access.search(query, 10);
+            check(found && found->size() == 1 && (*found)[0].ROWID == 3, std::string("recherche de ") + query);
+        }
+    }
+    std::filesystem::remove(path);
+
+    if (failures == 0)
+        std::cout << "SqliteDataAccess : OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
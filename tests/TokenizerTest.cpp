@@ -0,0 +1,37 @@
+#include "Tokenizer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+/*
+ * Tests du découpage en termes de la recherche.
+ */
+static int failures = 0;
+
+static void check(const std::string &text, const std::vector<std::string> &expected, bool keepStopWords = false)
+{
+    auto tokens = Tokenizer::tokenize(text, keepStopWords);
+    if (tokens == expected)
+        return;
+    failures++;
+    std::cout << "échec pour \"" << text << "\" :";
+    for (const auto &token : tokens)
+        std::cout << " [" << token << "]";
+    std::cout << std::endl;
+}
+
+int main()
+{
+    check("Comment Créer un compte ?", {"creer", "compte"});
+    check("<p>L&apos;<b>été</b></p>", {"ete"});
+    check("Œuvre l\xE2\x80\x99h\xC3\xB4tel", {"oeuvre", "hotel"});
+    // espace insécable avant la ponctuation, usage typographique français.
+    check("faire\xC2\xA0?", {"faire"});
+    check("\xC2\xAB\xC2\xA0" "devis\xC2\xA0\xC2\xBB", {"devis"});
+    // symbole monétaire : séparateur, comme pour l'index plein texte.
+    check("prix\xC2\xA0: 10\xC2\xA0\xE2\x82\xAC", {"prix", "10"});
+    check("10\xE2\x82\xAC" "HT", {"10", "ht"});
+
+    if (failures == 0)
+        std::cout << "Tokenizer : OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
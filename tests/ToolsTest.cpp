@@ -0,0 +1,31 @@
+#include "Tools.hpp"
+#include <iostream>
+#include <string>
+/*
+ * Tests de la négociation de l'encodage des réponses.
+ */
+static int failures = 0;
+
+static void check(const std::string &acceptEncoding, const std::string &encoding, bool expected)
+{
+    if (Tools::acceptsEncoding(acceptEncoding, encoding) == expected)
+        return;
+    failures++;
+    std::cout << "échec pour \"" << acceptEncoding << "\" et " << encoding << std::endl;
+}
+
+int main()
+{
+    check("gzip, deflate, br", "gzip", true);
+    check("br", "gzip", false);
+    check("deflate;q=0.5, gzip;q=0", "gzip", false);
+    check("*;q=0, gzip", "gzip", true);
+    check("*", "deflate", true);
+    // noms et paramètres insensibles à la casse (RFC 9110).
+    check("GZIP", "gzip", true);
+    check("Deflate; Q=0", "deflate", false);
+
+    if (failures == 0)
+        std::cout << "Tools : OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,331 @@
+/*
+ * Générateur de code C++ à partir d'un template mustache.
+ * Usage : mustache2cpp <template> <fichier .hpp généré> <namespace>
+ *
+ * Le template est transformé en une fonction
+ *   template <typename View> void render(std::string &out, const View &view)
+ * qui ajoute les morceaux de texte statique et appelle directement les accesseurs de la vue :
+ * - {{nom}} : CompiledTemplate::appendEscaped(out, view.nom(element))
+ * - {{{nom}}} ou {{&nom}} : out += view.nom(element)
+ * - {{#nom}} ... {{/nom}} : parcours de view.nom(element) (liste) ou test (booléen)
+ * - {{^nom}} ... {{/nom}} : bloc rendu si view.nom(element) est vide ou faux
+ * - {{>fichier}} : le partial est intégré au moment de la génération
+ * - {{! commentaire}} : ignoré
+ * element est l'élément de la liste englobante la plus proche (CompiledTemplate::Root au premier niveau).
+ * Les lignes ne contenant qu'une balise de bloc, de commentaire ou de partial sont retirées du rendu, comme le fait
+ * crow::mustache, afin que les deux rendus soient identiques.
+ */
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+enum class TokenType
+{
+    Text,
+    Escaped,
+    Unescaped,
+    Open,
+    Inverted,
+    Close,
+    Partial,
+    Comment
+};
+struct Token
+{
+    TokenType type;
+    std::string value;
+};
+
+std::string readFile(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("lecture impossible : " + path.string());
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+std::string trim(const std::string &value)
+{
+    auto start = value.find_first_not_of(' ');
+    auto end = value.find_last_not_of(' ');
+    return start == std::string::npos ? "" : value.substr(start, end - start + 1);
+}
+
+bool isStandaloneType(TokenType type)
+{
+    return type == TokenType::Open || type == TokenType::Inverted || type == TokenType::Close ||
+           type == TokenType::Partial || type == TokenType::Comment;
+}
+
+/*
+ * Découpage du template en texte et balises, partials intégrés.
+ */
+std::vector<Token> tokenize(const std::string &body, const std::filesystem::path &directory, int depth = 0)
+{
+    if (depth > 16)
+        throw std::runtime_error("partials imbriqués trop profondément");
+
+    std::vector<Token> tokens;
+    std::size_t current = 0;
+    while (current < body.size())
+    {
+        std::size_t open = body.find("{{", current);
+        if (open == std::string::npos)
+        {
+            tokens.push_back({TokenType::Text, body.substr(current)});
+            break;
+        }
+
+        bool triple = body.compare(open, 3, "{{{") == 0;
+        std::size_t close = body.find(triple ? "}}}" : "}}", open);
+        if (close == std::string::npos)
+            throw std::runtime_error("balise non fermée");
+        std::string tag = body.substr(open + (triple ? 3 : 2), close - open - (triple ? 3 : 2));
+        std::size_t after = close + (triple ? 3 : 2);
+        if (tag.empty())
+            throw std::runtime_error("balise vide");
+
+        Token token;
+        char sigil = tag[0];
+        if (triple)
+            token = {TokenType::Unescaped, trim(tag)};
+        else if (sigil == '#')
+            token = {TokenType::Open, trim(tag.substr(1))};
+        else if (sigil == '^')
+            token = {TokenType::Inverted, trim(tag.substr(1))};
+        else if (sigil == '/')
+            token = {TokenType::Close, trim(tag.substr(1))};
+        else if (sigil == '>')
+            token = {TokenType::Partial, trim(tag.substr(1))};
+        else if (sigil == '!')
+            token = {TokenType::Comment, ""};
+        else if (sigil == '&')
+            token = {TokenType::Unescaped, trim(tag.substr(1))};
+        else if (sigil == '=')
+            throw std::runtime_error("changement de délimiteurs non supporté");
+        else
+            token = {TokenType::Escaped, trim(tag)};
+
+        std::string before = body.substr(current, open - current);
+        std::string indentation;
+        if (isStandaloneType(token.type))
+        {
+            // balise seule sur sa ligne : la ligne entière disparaît du rendu.
+            std::size_t lineStart = 0;
+            if (open > 0 && body.rfind('\n', open - 1) != std::string::npos)
+                lineStart = body.rfind('\n', open - 1) + 1;
+            std::size_t lineEnd = body.find('\n', after);
+            bool blankBefore = body.find_first_not_of(" \t", lineStart) >= open;
+            bool blankAfter =
+                body.find_first_not_of(" \t\r", after) >= (lineEnd == std::string::npos ? body.size() : lineEnd);
+            if (lineStart >= current && blankBefore && blankAfter)
+            {
+                indentation = body.substr(lineStart, open - lineStart);
+                before.resize(before.size() - indentation.size());
+                after = lineEnd == std::string::npos ? body.size() : lineEnd + 1;
+            }
+        }
+        if (!before.empty())
+            tokens.push_back({TokenType::Text, before});
+
+        if (token.type == TokenType::Partial)
+        {
+            std::string partial = readFile(directory / token.value);
+            if (!indentation.empty())
+            {
+                // un partial seul sur sa ligne est indenté comme la balise.
+                std::string indented;
+                std::size_t start = 0;
+                while (start < partial.size())
+                {
+                    std::size_t end = partial.find('\n', start);
+                    end = end == std::string::npos ? partial.size() : end + 1;
+                    indented += indentation + partial.substr(start, end - start);
+                    start = end;
+                }
+                partial = indented;
+            }
+            for (auto &partialToken : tokenize(partial, directory, depth + 1))
+                tokens.push_back(std::move(partialToken));
+        }
+        else if (token.type != TokenType::Comment)
+            tokens.push_back(token);
+        current = after;
+    }
+    return tokens;
+}
+
+bool isIdentifier(const std::string &name)
+{
+    if (name.empty() || !(std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_'))
+        return false;
+    for (char c : name)
+        if (!(std::isalnum(static_cast<unsigned char>(c)) || c == '_'))
+            return false;
+    return true;
+}
+
+std::string literal(const std::string &text)
+{
+    std::string delimiter = "mustache";
+    while (text.find(")" + delimiter + "\"") != std::string::npos)
+        delimiter += "_";
+    return "std::string_view(R\"" + delimiter + "(" + text + ")" + delimiter + "\")";
+}
+
+/*
+ * Génération du corps de la fonction de rendu.
+ */
+std::string generate(const std::vector<Token> &tokens, std::size_t &textSize,
+                     std::vector<std::pair<std::string, std::size_t>> &sectionSizes)
+{
+    std::ostringstream code;
+    // pile des blocs ouverts : nom, variable de l'élément courant, index dans sectionSizes.
+    struct Block
+    {
+        std::string name;
+        std::string item;
+        std::size_t sizeIndex;
+    };
+    std::vector<Block> blocks;
+    std::string text;
+    int counter = 0;
+
+    auto indent = [&blocks]() { return std::string(4 * (blocks.size() + 1), ' '); };
+    auto item = [&blocks]() { return blocks.empty() ? std::string("root") : blocks.back().item; };
+    auto flush = [&]() {
+        if (text.empty())
+            return;
+        code << indent() << "out += " << literal(text) << ";\n";
+        if (blocks.empty())
+            textSize += text.size();
+        else
+            sectionSizes[blocks.back().sizeIndex].second += text.size();
+        text.clear();
+    };
+
+    for (const auto &token : tokens)
+    {
+        if (token.type == TokenType::Text)
+        {
+            text += token.value;
+            continue;
+        }
+        if (!isIdentifier(token.value))
+            throw std::runtime_error("nom de balise non supporté : " + token.value);
+        flush();
+        switch (token.type)
+        {
+            case TokenType::Escaped:
+                code << indent() << "CompiledTemplate::appendEscaped(out, view." << token.value << "(" << item()
+                     << "));\n";
+                break;
+            case TokenType::Unescaped:
+                code << indent() << "out += view." << token.value << "(" << item() << ");\n";
+                break;
+            case TokenType::Open:
+            case TokenType::Inverted: {
+                std::string suffix = std::to_string(++counter);
+                std::string values = token.value + "Values" + suffix;
+                // la valeur est conservée dans une variable pour prolonger la durée de vie d'un éventuel temporaire.
+                code << indent() << "const auto &" << values << " = view." << token.value << "(" << item()
+                     << ");\n";
+                if (token.type == TokenType::Open)
+                {
+                    std::string itemName = token.value + "Item" + suffix;
+                    code << indent() << "for (const auto &" << itemName << " : CompiledTemplate::iterate(" << values
+                         << ", " << item() << "))\n";
+                    code << indent() << "{\n";
+                    sectionSizes.push_back({token.value, 0});
+                    blocks.push_back({token.value, itemName, sectionSizes.size() - 1});
+                }
+                else
+                {
+                    code << indent() << "if (CompiledTemplate::isEmpty(" << values << "))\n";
+                    code << indent() << "{\n";
+                    sectionSizes.push_back({token.value, 0});
+                    blocks.push_back({token.value, item(), sectionSizes.size() - 1});
+                }
+                break;
+            }
+            case TokenType::Close:
+                if (blocks.empty() || blocks.back().name != token.value)
+                    throw std::runtime_error("fermeture de bloc inattendue : " + token.value);
+                blocks.pop_back();
+                code << indent() << "}\n";
+                break;
+            default:
+                break;
+        }
+    }
+    if (!blocks.empty())
+        throw std::runtime_error("bloc non fermé : " + blocks.back().name);
+    flush();
+    return code.str();
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage : mustache2cpp <template> <fichier généré> <namespace>" << std::endl;
+        return 1;
+    }
+    std::filesystem::path templatePath(argv[1]);
+    std::filesystem::path outputPath(argv[2]);
+    std::string ns(argv[3]);
+    try
+    {
+        auto tokens = tokenize(readFile(templatePath), templatePath.parent_path());
+        std::size_t textSize = 0;
+        std::vector<std::pair<std::string, std::size_t>> sectionSizes;
+        std::string body = generate(tokens, textSize, sectionSizes);
+
+        std::ostringstream header;
+        header << "// Fichier généré par mustache2cpp à partir de " << templatePath.filename().string()
+               << ", ne pas modifier.\n";
+        header << "#pragma once\n";
+        header << "#include \"CompiledTemplate.hpp\"\n";
+        header << "#include <cstddef>\n#include <string>\n#include <string_view>\n";
+        header << "namespace " << ns << "\n{\n";
+        header << "// taille du texte statique hors blocs.\n";
+        header << "inline constexpr std::size_t textSize = " << textSize << ";\n";
+        // un bloc présent plusieurs fois dans le template garde la plus grande taille.
+        std::map<std::string, std::size_t> blockSizes;
+        for (const auto &[name, size] : sectionSizes)
+            blockSizes[name] = std::max(blockSizes[name], size);
+        for (const auto &[name, size] : blockSizes)
+        {
+            header << "// taille du texte statique d'un passage dans le bloc " << name << ".\n";
+            header << "inline constexpr std::size_t " << name << "TextSize = " << size << ";\n";
+        }
+        header << "template <typename View> void render(std::string &out, const View &view)\n{\n";
+        header << "    [[maybe_unused]] CompiledTemplate::Root root;\n";
+        header << body;
+        header << "}\n} // namespace " << ns << "\n";
+
+        std::filesystem::create_directories(outputPath.parent_path());
+        std::ofstream output(outputPath, std::ios::binary);
+        output << header.str();
+        if (!output)
+            throw std::runtime_error("écriture impossible : " + outputPath.string());
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "mustache2cpp : " << argv[1] << " : " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}